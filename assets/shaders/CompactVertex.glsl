@@ -0,0 +1,12 @@
+// Set from Scene::VertexSpecialization(), true when the vertex buffer holds Assets::CompactVertex.
+layout(constant_id = 0) const bool CompactVertices = false;
+
+// Inverse of OctEncode() in Scene.cpp.
+vec3 OctDecode(vec2 e)
+{
+	vec3 n = vec3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+	const float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
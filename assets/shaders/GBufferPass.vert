@@ -3,6 +3,7 @@
 #extension GL_GOOGLE_include_directive : require
 #include "Material.glsl"
 #include "UniformBufferObject.glsl"
+#include "CompactVertex.glsl"
 
 layout(binding = 0) readonly uniform UniformBufferObjectStruct { UniformBufferObject Camera; };
 layout(binding = 1) readonly buffer MaterialArray { Material[] Materials; };
@@ -25,11 +26,13 @@ out gl_PerVertex
 
 void main()
 {
-	Material m = Materials[InMaterialIndex];
 	NodeProxy proxy = NodeProxies[gl_InstanceIndex];
+	const int materialIndex = InMaterialIndex + proxy.MaterialOffset;
+	Material m = Materials[materialIndex];
+	const vec3 normal = CompactVertices ? OctDecode(InNormal.xy) : InNormal;
 	gl_Position = Camera.Projection * Camera.ModelView * proxy.World * vec4(InPosition, 1.0);
 	FragColor = m.Diffuse.xyz;
-	FragNormal = InNormal; 
+	FragNormal = normal;
 	FragTexCoord = InTexCoord;
-	FragMaterialIndex = InMaterialIndex;
+	FragMaterialIndex = materialIndex;
 }
\ No newline at end of file
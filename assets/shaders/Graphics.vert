@@ -3,9 +3,11 @@
 #extension GL_GOOGLE_include_directive : require
 #include "Material.glsl"
 #include "UniformBufferObject.glsl"
+#include "CompactVertex.glsl"
 
 layout(binding = 0) readonly uniform UniformBufferObjectStruct { UniformBufferObject Camera; };
 layout(binding = 1) readonly buffer MaterialArray { Material[] Materials; };
+layout(binding = 3) readonly buffer NodeProxyArray { NodeProxy[] NodeProxies; };
 
 layout(location = 0) in vec3 InPosition;
 layout(location = 1) in vec3 InNormal;
@@ -24,11 +26,14 @@ out gl_PerVertex
 
 void main()
 {
-	Material m = Materials[InMaterialIndex];
+	NodeProxy proxy = NodeProxies[gl_InstanceIndex];
+	const int materialIndex = InMaterialIndex + proxy.MaterialOffset;
+	Material m = Materials[materialIndex];
+	const vec3 normal = mat3(proxy.World) * (CompactVertices ? OctDecode(InNormal.xy) : InNormal);
 
-	gl_Position = Camera.Projection * Camera.ModelView * vec4(InPosition, 1.0);
+	gl_Position = Camera.Projection * Camera.ModelView * proxy.World * vec4(InPosition, 1.0);
 	FragColor = m.Diffuse.xyz;
-	FragNormal = vec3(Camera.ModelView * vec4(InNormal, 0.0)); // technically not correct, should be ModelInverseTranspose
+	FragNormal = vec3(Camera.ModelView * vec4(normal, 0.0)); // technically not correct, should be ModelInverseTranspose
 	FragTexCoord = InTexCoord;
-	FragMaterialIndex = InMaterialIndex;
+	FragMaterialIndex = materialIndex;
 }
\ No newline at end of file
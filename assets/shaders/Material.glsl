@@ -27,9 +27,26 @@ struct LightObject
 	vec4 p1;
 	vec4 p3;
 	vec4 normal_area;
+	uint material_index;
+	uint triangle;
+	uint reserved1;
+	uint reserved2;
+};
+
+// Alias table slot, see Assets::AliasTable.
+struct AliasEntry
+{
+	float Threshold;
+	uint Alias;
+	float Pdf;
+	uint Reserved;
 };
 
 struct NodeProxy
 {
 	mat4 World;
+	uint ModelId;
+	int MaterialOffset;
+	uint Reserved0;
+	uint Reserved1;
 };
\ No newline at end of file
@@ -0,0 +1,11 @@
+// Matches Assets::ProceduralPrimitive, one per procedural node in world space.
+struct ProceduralPrimitive
+{
+	vec4 Data; // Sphere: center, radius
+	uint Type; // Assets::ProceduralType
+	int MaterialIndex;
+	uint Reserved0;
+	uint Reserved1;
+};
+
+const uint ProceduralTypeSphere = 0;
@@ -12,7 +12,7 @@ struct RayPayload
 	uint AdaptiveRay;
 	uint BounceCount;
 	float pdf;
-	uint primitiveId;
+	uvec2 primitiveId; // instance + material, compared across frames to reject reprojected history
 };
 
 // a simple box light may enough now
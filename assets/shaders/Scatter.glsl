@@ -12,7 +12,49 @@ float Schlick(const float cosine, const float refractionIndex)
 	return r0 + (1 - r0) * pow(1 - cosine, 5);
 }
 
-void ScatterDiffuseLight(inout RayPayload ray, const Material m, const LightObject light, const vec3 direction, const vec3 normal, const vec2 texCoord)
+// Picks a light proportionally to its power, expects the Lights and LightAlias buffers and Camera.LightCount > 0.
+uint SampleLight(inout uint seed, out float selectPdf)
+{
+	const uint slot = min(uint(RandomFloat(seed) * Camera.LightCount), Camera.LightCount - 1);
+	const AliasEntry entry = LightAlias[slot];
+	const uint index = RandomFloat(seed) < entry.Threshold ? slot : entry.Alias;
+
+	selectPdf = LightAlias[index].Pdf;
+	return index;
+}
+
+// Picks a sky direction proportionally to the clamped sky luminance, expects the SkyAlias buffer and Camera.SampleSky.
+vec3 SampleSky(inout uint seed)
+{
+	const float pi = 3.1415926535897932384626433832795;
+	const uint count = Camera.SkyCellsX * Camera.SkyCellsY;
+	const uint slot = min(uint(RandomFloat(seed) * count), count - 1);
+	const AliasEntry entry = SkyAlias[slot];
+	const uint cell = RandomFloat(seed) < entry.Threshold ? slot : entry.Alias;
+
+	// Uniform inside the cell, then the inverse of equirectangularSample() in RayTracing.rmiss.
+	const float u = (float(cell % Camera.SkyCellsX) + RandomFloat(seed)) / float(Camera.SkyCellsX);
+	const float v = (float(cell / Camera.SkyCellsX) + RandomFloat(seed)) / float(Camera.SkyCellsY);
+	const float phi = 2.0 * pi * u - pi * Camera.SkyRotation;
+	const float theta = pi * v;
+
+	return vec3(sin(theta) * sin(phi), cos(theta), sin(theta) * cos(phi));
+}
+
+// Solid angle pdf of SampleSky() returning this direction.
+float SkyPdf(const vec3 direction)
+{
+	const float pi = 3.1415926535897932384626433832795;
+	const float u = fract((atan(direction.x, direction.z) + pi * Camera.SkyRotation) / (2.0 * pi));
+	const float theta = acos(clamp(direction.y, -1.0, 1.0));
+	const uint x = min(uint(u * Camera.SkyCellsX), Camera.SkyCellsX - 1);
+	const uint y = min(uint(theta / pi * Camera.SkyCellsY), Camera.SkyCellsY - 1);
+
+	// The cells are uniform in (u, v), which covers 2 pi * pi * sin(theta) of solid angle.
+	return SkyAlias[y * Camera.SkyCellsX + x].Pdf * float(Camera.SkyCellsX * Camera.SkyCellsY) / (2.0 * pi * pi * max(sin(theta), 1e-4));
+}
+
+void ScatterDiffuseLight(inout RayPayload ray, const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord)
 {
 	ray.FrontFace = dot(direction, normal) < 0 ? 1 : 0;
 	ray.Distance = -1;
@@ -28,7 +70,7 @@ void ScatterDiffuseLight(inout RayPayload ray, const Material m, const LightObje
 	}
 }
 
-void ScatterLambertian(inout RayPayload ray, const Material m, const LightObject light, const vec3 direction, const vec3 normal, const vec2 texCoord)
+void ScatterLambertian(inout RayPayload ray, const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord)
 {
 	ray.FrontFace = dot(direction, normal) < 0 ? 1 : 0;
 	ray.Attenuation = ray.Albedo.rgb;
@@ -36,10 +78,19 @@ void ScatterLambertian(inout RayPayload ray, const Material m, const LightObject
 	ray.pdf = 1.0;
 	ray.EmitColor = vec4(0);
 
-	if( light.normal_area.w > 0 && RandomFloat(ray.RandomSeed) < 0.5 )
+	if( Camera.LightCount > 0 && RandomFloat(ray.RandomSeed) < 0.5 )
 	{
 		// scatter to light
-		vec3 lightpos = light.p0.xyz + (light.p1.xyz - light.p0.xyz) * RandomFloat(ray.RandomSeed) + (light.p3.xyz - light.p0.xyz) *  RandomFloat(ray.RandomSeed);
+		float selectPdf;
+		const LightObject light = Lights[SampleLight(ray.RandomSeed, selectPdf)];
+		float r1 = RandomFloat(ray.RandomSeed);
+		float r2 = RandomFloat(ray.RandomSeed);
+		if (light.triangle != 0 && r1 + r2 > 1)
+		{
+			r1 = 1 - r1;
+			r2 = 1 - r2;
+		}
+		vec3 lightpos = light.p0.xyz + (light.p1.xyz - light.p0.xyz) * r1 + (light.p3.xyz - light.p0.xyz) * r2;
 		vec3 worldPos = gl_WorldRayOriginEXT + gl_WorldRayDirectionEXT * gl_HitTEXT;
 		vec3 tolight = lightpos - worldPos;
 		float dist = length(tolight);
@@ -47,18 +98,31 @@ void ScatterLambertian(inout RayPayload ray, const Material m, const LightObject
 
 		const float epsVariance      = .01;
 		float cosine = max(dot(light.normal_area.xyz, -tolight), epsVariance);
-		float light_pdf = dist * dist / (cosine * light.normal_area.w);
+		float light_pdf = selectPdf * dist * dist / (cosine * light.normal_area.w);
 		float ndotl = dot(tolight, normal);
 		
-		if(ndotl >= 0)
+		if(ndotl >= 0 && light.normal_area.w > 0)
 		{
 			ray.ScatterDirection = tolight;
 			ray.pdf = 1.0f / light_pdf;
 		}
 	}
+	else if (Camera.SampleSky)
+	{
+		// One-sample MIS between the cosine lobe and the sky, the balance heuristic weight of whichever direction
+		// got picked only needs both pdfs.
+		if (RandomFloat(ray.RandomSeed) < 0.5)
+		{
+			ray.ScatterDirection = SampleSky(ray.RandomSeed);
+		}
+
+		const float pi = 3.1415926535897932384626433832795;
+		const float lobePdf = dot(ray.ScatterDirection, normal) / pi;
+		ray.pdf = lobePdf > 0 ? lobePdf / (0.5 * lobePdf + 0.5 * SkyPdf(ray.ScatterDirection)) : 0.0;
+	}
 }
 
-void ScatterDieletricOpaque(inout RayPayload ray, const Material m, const LightObject light, const vec3 direction, const vec3 normal, const vec2 texCoord)
+void ScatterDieletricOpaque(inout RayPayload ray, const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord)
 {
 	ray.FrontFace = dot(direction, normal) < 0 ? 1 : 0;
 	ray.Attenuation = vec3(1.0);
@@ -67,7 +131,7 @@ void ScatterDieletricOpaque(inout RayPayload ray, const Material m, const LightO
 	ray.EmitColor = vec4(0);
 }
 
-void ScatterMetallic(inout RayPayload ray, const Material m, const LightObject light, const vec3 direction, const vec3 normal, const vec2 texCoord)
+void ScatterMetallic(inout RayPayload ray, const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord)
 {
 	ray.FrontFace = dot(direction, normal) < 0 ? 1 : 0;
 	ray.Attenuation = ray.Albedo.rgb;
@@ -76,7 +140,7 @@ void ScatterMetallic(inout RayPayload ray, const Material m, const LightObject l
 	ray.EmitColor = vec4(0);
 }
 
-void ScatterDieletric(inout RayPayload ray, const Material m, const LightObject light, const vec3 direction, const vec3 normal, const vec2 texCoord)
+void ScatterDieletric(inout RayPayload ray, const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord)
 {
 	const float dot = dot(direction, normal);
 	ray.FrontFace = dot < 0 ? 1 : 0;
@@ -109,7 +173,7 @@ void ScatterDieletric(inout RayPayload ray, const Material m, const LightObject
 }
 
 // Mixture
-void ScatterMixture(inout RayPayload ray, const Material m, const LightObject light, const vec3 direction, const vec3 normal, const vec2 texCoord)
+void ScatterMixture(inout RayPayload ray, const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord)
 {
     const float dot = dot(direction, normal);
 	const float cosine = dot > 0 ? m.RefractionIndex * dot : -dot;
@@ -117,19 +181,19 @@ void ScatterMixture(inout RayPayload ray, const Material m, const LightObject li
 	
     if( RandomFloat(ray.RandomSeed) < reflectProb )
 	{
-		ScatterDieletricOpaque(ray,m,light,direction,normal,texCoord);
+		ScatterDieletricOpaque(ray,m,direction,normal,texCoord);
 	}
 	else if( RandomFloat(ray.RandomSeed) < m.Metalness)
 	{
-		ScatterMetallic(ray,m,light,direction,normal,texCoord);
+		ScatterMetallic(ray,m,direction,normal,texCoord);
 	}
 	else
 	{
-		ScatterLambertian(ray,m,light,direction,normal,texCoord);
+		ScatterLambertian(ray,m,direction,normal,texCoord);
 	}
 }
 
-void Scatter(inout RayPayload ray, const Material m, const LightObject light, const vec3 direction, const vec3 normal, const vec2 texCoord, const float t)
+void Scatter(inout RayPayload ray, const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord, const float t)
 {
 	const vec4 texColor = m.DiffuseTextureId >= 0 ? texture(TextureSamplers[nonuniformEXT(m.DiffuseTextureId)], texCoord) : vec4(1);
 	
@@ -140,22 +204,22 @@ void Scatter(inout RayPayload ray, const Material m, const LightObject light, co
 	switch (m.MaterialModel)
 	{
 	case MaterialLambertian:
-		ScatterLambertian(ray, m, light, direction, normal, texCoord);
+		ScatterLambertian(ray, m, direction, normal, texCoord);
 		break;
 	case MaterialMetallic:
-		ScatterMetallic(ray, m, light, direction, normal, texCoord);
+		ScatterMetallic(ray, m, direction, normal, texCoord);
 		break;
 	case MaterialDielectric:
-		ScatterDieletric(ray, m, light, direction, normal, texCoord);
+		ScatterDieletric(ray, m, direction, normal, texCoord);
 		break;
 	case MaterialDiffuseLight:
-		ScatterDiffuseLight(ray, m, light, direction, normal, texCoord);
+		ScatterDiffuseLight(ray, m, direction, normal, texCoord);
 		break;
 	case MaterialMixture:
-		ScatterMixture(ray, m, light, direction, normal, texCoord);
+		ScatterMixture(ray, m, direction, normal, texCoord);
 	    break;
 	case MaterialIsotropic:
-	    ScatterLambertian(ray, m, light, direction, normal, texCoord);
+	    ScatterLambertian(ray, m, direction, normal, texCoord);
 	    break;
 	}
 }
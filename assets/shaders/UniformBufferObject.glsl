@@ -25,4 +25,8 @@ struct UniformBufferObject
 	bool ShowHeatmap;
 	bool UseCheckerBoard;
 	uint TemporalFrames;
+	bool SampleSky;
+	uint SkyCellsX;
+	uint SkyCellsY;
+	bool HeatmapRays;
 };
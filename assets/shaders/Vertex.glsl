@@ -1,3 +1,4 @@
+#include "CompactVertex.glsl"
 
 struct Vertex
 {
@@ -9,6 +10,20 @@ struct Vertex
 
 Vertex UnpackVertex(uint index)
 {
+	if (CompactVertices)
+	{
+		const uint offset = index * 6;
+
+		Vertex v;
+
+		v.Position = vec3(Vertices[offset + 0], Vertices[offset + 1], Vertices[offset + 2]);
+		v.Normal = OctDecode(unpackSnorm2x16(floatBitsToUint(Vertices[offset + 3])));
+		v.TexCoord = unpackHalf2x16(floatBitsToUint(Vertices[offset + 4]));
+		v.MaterialIndex = floatBitsToInt(Vertices[offset + 5]);
+
+		return v;
+	}
+
 	const uint vertexSize = 9;
 	const uint offset = index * vertexSize;
 	
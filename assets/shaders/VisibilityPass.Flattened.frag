@@ -0,0 +1,12 @@
+#version 460
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (location = 0) flat in uint g_instance_index;
+layout (location = 1) flat in uint g_triangle_index;
+layout(location = 0) out uvec2 g_out_color;
+
+void main() 
+{
+	// gl_PrimitiveID fallback for devices without geometryShader, the vertex shader derives the triangle from gl_VertexIndex
+	g_out_color = uvec2(g_instance_index, g_triangle_index);
+}
\ No newline at end of file
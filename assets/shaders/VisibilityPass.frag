@@ -4,10 +4,11 @@
 #extension GL_GOOGLE_include_directive : require
 #include "Material.glsl"
 
-layout (location = 0) flat in uint g_primitive_index;
-layout(location = 0) out uint g_out_color;
+layout (location = 0) flat in uint g_instance_index;
+layout(location = 0) out uvec2 g_out_color;
 
 void main() 
 {
-	g_out_color = g_primitive_index;
+	// full instance index and triangle index within the model, works for both indexed and flattened geometry (needs geometryShader)
+	g_out_color = uvec2(g_instance_index, gl_PrimitiveID);
 }
\ No newline at end of file
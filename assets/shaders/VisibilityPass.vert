@@ -6,10 +6,12 @@
 
 layout(binding = 0) readonly uniform UniformBufferObjectStruct { UniformBufferObject Camera; };
 layout(binding = 1) readonly buffer NodeProxyArray { NodeProxy[] NodeProxies; };
+layout(binding = 2) readonly buffer OffsetArray { uvec2[] Offsets; };
 
 layout(location = 0) in vec3 InPosition;
 
-layout(location = 0) out flat uint g_out_primitive_index;
+layout(location = 0) out flat uint g_out_instance_index;
+layout(location = 1) out flat uint g_out_triangle_index;
 
 out gl_PerVertex
 {
@@ -20,6 +22,7 @@ void main()
 {
 	NodeProxy proxy = NodeProxies[gl_InstanceIndex];
     gl_Position = Camera.Projection * Camera.ModelView * proxy.World * vec4(InPosition, 1.0);
-	g_out_primitive_index = (gl_VertexIndex / 3) | (gl_InstanceIndex << 20);
-	//g_out_primitive_index = gl_VertexIndex / 3;
+	g_out_instance_index = gl_InstanceIndex;
+	// only meaningful for flattened geometry, where the provoking vertex is the triangle's first index
+	g_out_triangle_index = (gl_VertexIndex - Offsets[proxy.ModelId].y) / 3;
 }
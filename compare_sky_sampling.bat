@@ -0,0 +1,32 @@
+@echo off
+
+rem Convergence of sky importance sampling: renders a high sample count reference once, then the same scene at a low
+rem sample count with and without --no-sky-sampling, and prints the RMSE of both against the reference.
+rem Usage: compare_sky_sampling.bat [scene] [samples] [reference samples]
+set SCENE=%1
+set SAMPLES=%2
+set REFERENCE_SAMPLES=%3
+if "%SCENE%"=="" set SCENE=0
+if "%SAMPLES%"=="" set SAMPLES=16
+if "%REFERENCE_SAMPLES%"=="" set REFERENCE_SAMPLES=1024
+set REFERENCE=sky_reference_%SCENE%.raw
+
+cd build\windows\bin || goto :error
+if exist %REFERENCE% del %REFERENCE%
+
+echo Reference (%REFERENCE_SAMPLES% spp)
+gkNextRenderer.exe --headless --scene=%SCENE% --frames=1 --samples=%REFERENCE_SAMPLES% --reference=%REFERENCE% || goto :error
+
+echo Sky sampling (%SAMPLES% spp)
+gkNextRenderer.exe --headless --scene=%SCENE% --frames=1 --samples=%SAMPLES% --reference=%REFERENCE% | findstr "Reference"
+
+echo BSDF only (%SAMPLES% spp)
+gkNextRenderer.exe --headless --scene=%SCENE% --frames=1 --samples=%SAMPLES% --no-sky-sampling --reference=%REFERENCE% | findstr "Reference"
+cd ..\..\..
+
+exit /b
+
+
+:error
+echo Failed with error #%errorlevel%.
+exit /b %errorlevel%
@@ -0,0 +1,22 @@
+#!/bin/sh
+set -e
+
+# Convergence of sky importance sampling: renders a high sample count reference once, then the same scene at a low
+# sample count with and without --no-sky-sampling, and prints the RMSE of both against the reference.
+# Usage: ./compare_sky_sampling.sh [scene] [samples] [reference samples]
+SCENE=${1:-0}
+SAMPLES=${2:-16}
+REFERENCE_SAMPLES=${3:-1024}
+REFERENCE=sky_reference_$SCENE.raw
+
+cd build/linux/bin
+rm -f $REFERENCE
+
+echo "Reference ($REFERENCE_SAMPLES spp)"
+./gkNextRenderer --headless --scene=$SCENE --frames=1 --samples=$REFERENCE_SAMPLES --reference=$REFERENCE | grep -e "Reference" -e "reference"
+
+echo "Sky sampling ($SAMPLES spp)"
+./gkNextRenderer --headless --scene=$SCENE --frames=1 --samples=$SAMPLES --reference=$REFERENCE | grep "Reference"
+
+echo "BSDF only ($SAMPLES spp)"
+./gkNextRenderer --headless --scene=$SCENE --frames=1 --samples=$SAMPLES --no-sky-sampling --reference=$REFERENCE | grep "Reference"
@@ -1,16 +1,29 @@
 #include "Application.hpp"
 #include "UserInterface.hpp"
 #include "UserSettings.hpp"
+#include "Assets/GeometryDedup.hpp"
 #include "Assets/Model.hpp"
 #include "Assets/Scene.hpp"
 #include "Assets/Texture.hpp"
 #include "Assets/UniformBuffer.hpp"
+#include "Utilities/AtomicFile.hpp"
+#include "Utilities/Console.hpp"
 #include "Utilities/Exception.hpp"
 #include "Utilities/Glm.hpp"
+#include "Utilities/ThreadPool.hpp"
+#include "Utilities/Tracer.hpp"
 #include "Vulkan/Window.hpp"
 #include "Vulkan/SwapChain.hpp"
 #include "Vulkan/Device.hpp"
+#include "Vulkan/GpuProfiler.hpp"
+#include "Vulkan/MemoryAllocator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <numeric>
 #include <sstream>
 
 #include "Options.hpp"
@@ -27,6 +40,298 @@ namespace
 #else
         true;
 #endif
+
+    // Seconds between two frames once the image has converged, unless some input wakes the application earlier.
+    const double ConvergedFrameInterval = 0.1;
+
+    struct FrameTimeStatistics
+    {
+        double Min{};
+        double Avg{};
+        double P50{};
+        double P95{};
+        double P99{};
+        double Max{};
+        uint32_t Stutters{};
+    };
+
+    // Frame times in milliseconds, percentiles by nearest rank. A stutter is a frame taking more than twice the median.
+    FrameTimeStatistics ComputeFrameTimeStatistics(std::vector<double> frameTimes)
+    {
+        FrameTimeStatistics stats{};
+
+        if (frameTimes.empty())
+        {
+            return stats;
+        }
+
+        std::sort(frameTimes.begin(), frameTimes.end());
+
+        const auto percentile = [&frameTimes](const double p)
+        {
+            const auto rank = static_cast<size_t>(std::ceil(p * frameTimes.size()));
+            return frameTimes[std::clamp<size_t>(rank, 1, frameTimes.size()) - 1];
+        };
+
+        stats.Min = frameTimes.front();
+        stats.Avg = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0) / frameTimes.size();
+        stats.P50 = percentile(0.50);
+        stats.P95 = percentile(0.95);
+        stats.P99 = percentile(0.99);
+        stats.Max = frameTimes.back();
+        stats.Stutters = static_cast<uint32_t>(std::count_if(frameTimes.begin(), frameTimes.end(), [&stats](const double ms)
+        {
+            return ms > 2 * stats.P50;
+        }));
+
+        return stats;
+    }
+
+    // Everything a finished benchmark scene hands over to the report worker.
+    struct BenchmarkReport
+    {
+        std::string SceneName;
+        std::string Json;
+        std::vector<double> FrameTimes;
+
+        // A2R10G10B10 readback of the swap chain, empty when no screenshot is wanted.
+        std::vector<uint32_t> Pixels;
+        uint32_t Width{};
+        uint32_t Height{};
+        uint16_t MaxCLL{};
+
+        bool Upload{};
+    };
+
+    // Copies the last swap chain readback out of the screenshot memory, the next frames keep writing into it.
+    void CopyReadback(Vulkan::DeviceMemory& memory, const VkExtent2D extent, const float paperWhiteNit, BenchmarkReport& report)
+    {
+        report.Width = extent.width;
+        report.Height = extent.height;
+        report.MaxCLL = static_cast<uint16_t>(paperWhiteNit);
+        report.Pixels.resize(static_cast<size_t>(extent.width) * extent.height);
+
+        const auto size = report.Pixels.size() * sizeof(uint32_t);
+        std::memcpy(report.Pixels.data(), memory.Map(0, size), size);
+        memory.Unmap();
+    }
+
+    // One flat branchless pass over the pixels, which the compiler turns into SIMD shifts and masks.
+    std::vector<uint16_t> UnpackA2R10G10B10(const std::vector<uint32_t>& pixels)
+    {
+        std::vector<uint16_t> unpacked(pixels.size() * 3);
+
+        const uint32_t* src = pixels.data();
+        uint16_t* dst = unpacked.data();
+        const size_t count = pixels.size();
+
+        for (size_t i = 0; i != count; ++i)
+        {
+            const uint32_t pixel = src[i];
+            dst[i * 3 + 0] = static_cast<uint16_t>((pixel >> 20) & 0x3ff);
+            dst[i * 3 + 1] = static_cast<uint16_t>((pixel >> 10) & 0x3ff);
+            dst[i * 3 + 2] = static_cast<uint16_t>(pixel & 0x3ff);
+        }
+
+        return unpacked;
+    }
+
+    void SaveScreenshot(const BenchmarkReport& report)
+    {
+        avifImage* image = avifImageCreate(report.Width, report.Height, 10,
+                                           AVIF_PIXEL_FORMAT_YUV444); // these values dictate what goes into the final AVIF
+        if (!image)
+        {
+            Throw(std::runtime_error("avif image creation failed"));
+        }
+        image->yuvRange = AVIF_RANGE_FULL;
+        image->colorPrimaries = AVIF_COLOR_PRIMARIES_BT2020;
+        image->transferCharacteristics = AVIF_TRANSFER_CHARACTERISTICS_SMPTE2084;
+        image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_IDENTITY;
+        image->clli.maxCLL = report.MaxCLL; //maxCLLNits;
+        image->clli.maxPALL = 0; //maxFALLNits;
+
+        avifRGBImage rgbAvifImage{};
+        avifRGBImageSetDefaults(&rgbAvifImage, image);
+        rgbAvifImage.format = AVIF_RGB_FORMAT_BGR;
+        rgbAvifImage.ignoreAlpha = AVIF_TRUE;
+
+        std::vector<uint16_t> data = UnpackA2R10G10B10(report.Pixels);
+        rgbAvifImage.pixels = reinterpret_cast<uint8_t*>(data.data());
+        rgbAvifImage.rowBytes = rgbAvifImage.width * 3 * sizeof(uint16_t);
+
+        avifResult convertResult = avifImageRGBToYUV(image, &rgbAvifImage);
+        if (convertResult != AVIF_RESULT_OK)
+        {
+            avifImageDestroy(image);
+            Throw(std::runtime_error("Failed to convert RGB to YUV: " + std::string(avifResultToString(convertResult))));
+        }
+
+        avifEncoder* encoder = avifEncoderCreate();
+        if (!encoder)
+        {
+            avifImageDestroy(image);
+            Throw(std::runtime_error("Failed to create encoder"));
+        }
+        encoder->quality = 80;
+        encoder->qualityAlpha = AVIF_QUALITY_LOSSLESS;
+        encoder->speed = AVIF_SPEED_FASTEST;
+
+        avifRWData avifOutput = AVIF_DATA_EMPTY;
+        avifResult result = avifEncoderAddImage(encoder, image, 1, AVIF_ADD_IMAGE_FLAG_SINGLE);
+        if (result == AVIF_RESULT_OK)
+        {
+            result = avifEncoderFinish(encoder, &avifOutput);
+        }
+
+        avifEncoderDestroy(encoder);
+        avifImageDestroy(image);
+
+        if (result != AVIF_RESULT_OK)
+        {
+            avifRWDataFree(&avifOutput);
+            Throw(std::runtime_error("Failed to encode image: " + std::string(avifResultToString(result))));
+        }
+
+        // save to file with scenename
+        std::string filename = report.SceneName + ".avif";
+        FILE* f = fopen(filename.c_str(), "wb");
+        if (!f)
+        {
+            avifRWDataFree(&avifOutput);
+            Throw(std::runtime_error("Failed to open file for writing"));
+        }
+        fwrite(avifOutput.data, 1, avifOutput.size, f);
+        fclose(f);
+
+        // send to server
+        //img_encoded = base64_encode(avifOutput.data, avifOutput.size, false);
+        avifRWDataFree(&avifOutput);
+    }
+
+    // Local report, the summary as json and every frame time as csv.
+    void WriteReport(const BenchmarkReport& report)
+    {
+        const std::string reportName = report.SceneName + ".benchmark.json";
+        const std::string framesName = report.SceneName + ".frames.csv";
+
+        std::ofstream out(reportName, std::ios::trunc);
+        out << report.Json << std::endl;
+
+        std::ofstream frames(framesName, std::ios::trunc);
+        frames << "frame,ms\n";
+        for (size_t i = 0; i != report.FrameTimes.size(); ++i)
+        {
+            frames << i << ',' << report.FrameTimes[i] << '\n';
+        }
+
+        if (!out || !frames)
+        {
+            Throw(std::runtime_error("failed to write benchmark report '" + reportName + "'"));
+        }
+
+        std::cout << "- wrote benchmark report '" << reportName << "' and '" << framesName << "'" << std::endl;
+    }
+
+    void UploadReport(const BenchmarkReport& report)
+    {
+        std::cout << "Sending benchmark to perf server..." << std::endl;
+        // upload from curl, curl_global_init() is done once by the application
+        CURL* curl = curl_easy_init();
+        if (curl)
+        {
+            curl_slist* slist1 = nullptr;
+            slist1 = curl_slist_append(slist1, "Content-Type: application/json");
+            slist1 = curl_slist_append(slist1, "Accept: application/json");
+
+            /* set custom headers */
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, slist1);
+
+            curl_easy_setopt(curl, CURLOPT_URL, "http://gameknife.site:60010/rt_benchmark");
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, report.Json.c_str());
+
+            // An unreachable server only ever delays the worker, and not for long.
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 15L);
+
+            /* Perform the request, res gets the return code */
+            const CURLcode res = curl_easy_perform(curl);
+            /* Check for errors */
+            if (res != CURLE_OK)
+                fprintf(stderr, "curl_easy_perform() failed: %s\n",
+                        curl_easy_strerror(res));
+
+            /* always cleanup */
+            curl_slist_free_all(slist1);
+            curl_easy_cleanup(curl);
+        }
+    }
+
+    // Runs on the report worker, in the order the scenes finished.
+    void ProcessReport(const BenchmarkReport& report)
+    {
+        TRACE_ZONE("Process Report");
+
+        if (!report.Pixels.empty())
+        {
+            SaveScreenshot(report);
+        }
+
+        WriteReport(report);
+
+        if (report.Upload)
+        {
+            UploadReport(report);
+        }
+    }
+
+    // Headless --reference: the raw readback (width, height, A2R10G10B10 pixels) of a well converged render. The first
+    // run writes it, the next ones print the RMSE of their last frame against it, over the 10 bit channels in [0, 1].
+    void CompareWithReference(const BenchmarkReport& report, const std::string& filename)
+    {
+        std::ifstream in(filename, std::ios::binary);
+        if (!in)
+        {
+            const bool written = Utilities::AtomicFile::Write(filename, std::ios::binary, [&report](std::ofstream& out)
+            {
+                out.write(reinterpret_cast<const char*>(&report.Width), sizeof(report.Width));
+                out.write(reinterpret_cast<const char*>(&report.Height), sizeof(report.Height));
+                out.write(reinterpret_cast<const char*>(report.Pixels.data()), report.Pixels.size() * sizeof(uint32_t));
+            });
+
+            if (!written)
+            {
+                Throw(std::runtime_error("failed to write reference '" + filename + "'"));
+            }
+
+            std::cout << "- wrote reference '" << filename << "'" << std::endl;
+            return;
+        }
+
+        uint32_t width = 0;
+        uint32_t height = 0;
+        in.read(reinterpret_cast<char*>(&width), sizeof(width));
+        in.read(reinterpret_cast<char*>(&height), sizeof(height));
+
+        std::vector<uint32_t> pixels(report.Pixels.size());
+        if (!in || width != report.Width || height != report.Height ||
+            !in.read(reinterpret_cast<char*>(pixels.data()), pixels.size() * sizeof(uint32_t)))
+        {
+            Throw(std::runtime_error("reference '" + filename + "' is unreadable or of another resolution"));
+        }
+
+        const auto image = UnpackA2R10G10B10(report.Pixels);
+        const auto reference = UnpackA2R10G10B10(pixels);
+
+        double sum = 0;
+        for (size_t i = 0; i != image.size(); ++i)
+        {
+            const double delta = (static_cast<double>(image[i]) - reference[i]) / 1023.0;
+            sum += delta * delta;
+        }
+
+        std::cout << "Reference: RMSE " << std::sqrt(sum / image.size()) << " against '" << filename << "'" << std::endl;
+    }
 }
 
 template <typename Renderer>
@@ -34,14 +339,24 @@ NextRendererApplication<Renderer>::NextRendererApplication(const UserSettings& u
                                                            const Vulkan::WindowConfig& windowConfig,
                                                            const VkPresentModeKHR presentMode) :
     Renderer(windowConfig, presentMode, EnableValidationLayers),
-    userSettings_(userSettings)
+    userSettings_(userSettings),
+    reportWorker_(new Utilities::ThreadPool(1))
 {
     CheckFramebufferSize();
+
+    Renderer::maxBounces_ = userSettings_.NumberOfBounces;
+
+    curl_global_init(CURL_GLOBAL_ALL);
 }
 
 template <typename Renderer>
 NextRendererApplication<Renderer>::~NextRendererApplication()
 {
+    // Let the last reports finish writing before leaving.
+    CollectReports(true);
+    reportWorker_.reset();
+    curl_global_cleanup();
+
     scene_.reset();
 }
 
@@ -71,6 +386,7 @@ Assets::UniformBufferObject NextRendererApplication<Renderer>::GetUniformBufferO
     ubo.RandomSeed = rand();
     ubo.HasSky = init.HasSky;
     ubo.ShowHeatmap = userSettings_.ShowHeatmap;
+    ubo.HeatmapRays = userSettings_.HeatmapRays;
     ubo.HeatmapScale = userSettings_.HeatmapScale;
     ubo.UseCheckerBoard = userSettings_.UseCheckerBoardRendering;
     ubo.TemporalFrames = userSettings_.TemporalFrames;
@@ -81,6 +397,9 @@ Assets::UniformBufferObject NextRendererApplication<Renderer>::GetUniformBufferO
     ubo.PaperWhiteNit = userSettings_.PaperWhiteNit;
 
     ubo.LightCount = scene_->GetLightCount();
+    ubo.SampleSky = init.HasSky && userSettings_.SampleSky && scene_->SkyAliasCells().x != 0;
+    ubo.SkyCellsX = scene_->SkyAliasCells().x;
+    ubo.SkyCellsY = scene_->SkyAliasCells().y;
 
     prevUBO_ = ubo;
 
@@ -131,11 +450,18 @@ void NextRendererApplication<Renderer>::CreateSwapChain()
 {
     Renderer::CreateSwapChain();
 
-    userInterface_.reset(new UserInterface(Renderer::CommandPool(), Renderer::SwapChain(), Renderer::DepthBuffer(),
-                                           userSettings_));
+    // ImGui needs a GLFW window.
+    if (!Renderer::Window().Config().Headless)
+    {
+        userInterface_.reset(new UserInterface(Renderer::CommandPool(), Renderer::SwapChain(), Renderer::DepthBuffer(),
+                                               userSettings_));
+    }
     resetAccumulation_ = true;
 
     CheckFramebufferSize();
+
+    // Everything the scene and the swap chain need is allocated by now.
+    Renderer::Device().Allocator().PrintStatistics();
 }
 
 template <typename Renderer>
@@ -149,6 +475,13 @@ void NextRendererApplication<Renderer>::DeleteSwapChain()
 template <typename Renderer>
 void NextRendererApplication<Renderer>::DrawFrame()
 {
+    // Nothing moves on screen once converged, sleep until some input arrives rather than presenting as fast as
+    // the swap chain allows. The timeout keeps the overlay ticking.
+    if (Renderer::frameConverged_ && !userSettings_.Benchmark)
+    {
+        Renderer::Window().WaitForEvents(ConvergedFrameInterval);
+    }
+
     // Check if the scene has been changed by the user.
     if (sceneIndex_ != static_cast<uint32_t>(userSettings_.SceneIndex))
     {
@@ -161,6 +494,14 @@ void NextRendererApplication<Renderer>::DrawFrame()
         return;
     }
 
+    // The bounce limit is compiled into the ray tracing pipeline, the renderer rebuilds just that.
+    if (Renderer::maxBounces_ != userSettings_.NumberOfBounces)
+    {
+        Renderer::maxBounces_ = userSettings_.NumberOfBounces;
+        Renderer::OnMaxBouncesChanged();
+        resetAccumulation_ = true;
+    }
+
     // Check if the accumulation buffer needs to be reset.
     if (resetAccumulation_ ||
         userSettings_.RequiresAccumulationReset(previousSettings_) ||
@@ -170,6 +511,7 @@ void NextRendererApplication<Renderer>::DrawFrame()
         resetAccumulation_ = false;
     }
 
+    const bool recompose = userSettings_.RequiresRecompose(previousSettings_);
     previousSettings_ = userSettings_;
 
     // Keep track of our sample count.
@@ -177,9 +519,19 @@ void NextRendererApplication<Renderer>::DrawFrame()
                                   userSettings_.NumberOfSamples);
     totalNumberOfSamples_ += numberOfSamples_;
 
+    // The last composed image stays valid until the camera, the scene or the settings change. Renderers that
+    // keep running their passes also keep advancing their ping-pong, so they never count as converged.
+    Renderer::frameConverged_ = Renderer::SupportsConvergedIdle() && numberOfSamples_ == 0 && totalNumberOfSamples_ != 0 && !recompose;
+
     Renderer::DrawFrame();
 
-    totalFrames_ += 1;
+    // The accumulation ping-pong follows the frame index, converged frames must not advance it.
+    totalFrames_ += Renderer::frameConverged_ ? 0 : 1;
+
+    if (Renderer::Window().Config().Headless && !userSettings_.Benchmark)
+    {
+        CheckHeadlessLimit();
+    }
 }
 
 template <typename Renderer>
@@ -196,6 +548,17 @@ void NextRendererApplication<Renderer>::Render(VkCommandBuffer commandBuffer, co
     // Check the current state of the benchmark, update it for the new frame.
     CheckAndUpdateBenchmarkState(prevTime);
 
+    AnimateNode();
+
+    // Push the nodes moved since the last frame, before anything reads them.
+    if (!scene_->DirtyNodes().empty())
+    {
+        scene_->RecordNodeUpdates(commandBuffer);
+        Renderer::OnNodesMoved(commandBuffer, scene_->DirtyNodes());
+        scene_->ClearDirtyNodes();
+        resetAccumulation_ = true;
+    }
+
     Renderer::denoiseIteration_ = userSettings_.DenoiseIteration;
     Renderer::checkerboxRendering_ = userSettings_.UseCheckerBoardRendering;
 
@@ -211,6 +574,12 @@ void NextRendererApplication<Renderer>::Render(VkCommandBuffer commandBuffer, co
     stats.CamPosY = modelViewController_.Position()[1];
     stats.CamPosZ = modelViewController_.Position()[2];
 
+    for (const auto& zone : Renderer::GpuProfiler().Zones())
+    {
+        stats.GpuTimes.emplace_back(zone.Name, static_cast<float>(zone.AverageMs));
+    }
+    stats.GpuFrameTime = static_cast<float>(Renderer::GpuProfiler().FrameAverageMs());
+
     if (userSettings_.IsRayTraced)
     {
         const auto extent = Renderer::SwapChain().Extent();
@@ -222,7 +591,12 @@ void NextRendererApplication<Renderer>::Render(VkCommandBuffer commandBuffer, co
         stats.TotalSamples = totalNumberOfSamples_;
     }
 
-    userInterface_->Render(commandBuffer, Renderer::SwapChainFrameBuffer(imageIndex), stats);
+    if (userInterface_)
+    {
+        Renderer::GpuProfiler().BeginZone(commandBuffer, "UI");
+        userInterface_->Render(commandBuffer, Renderer::SwapChainFrameBuffer(imageIndex), stats);
+        Renderer::GpuProfiler().EndZone(commandBuffer);
+    }
 }
 
 template <typename Renderer>
@@ -239,6 +613,12 @@ void NextRendererApplication<Renderer>::OnKey(int key, int scancode, int action,
         {
         case GLFW_KEY_ESCAPE: Renderer::Window().Close();
             break;
+        case GLFW_KEY_F3:
+            if (Utilities::Tracer::IsEnabled())
+            {
+                Utilities::Tracer::Dump(GOption->TraceFile);
+            }
+            break;
         default: break;
         }
 
@@ -318,12 +698,16 @@ void NextRendererApplication<Renderer>::OnScroll(const double xoffset, const dou
 template <typename Renderer>
 void NextRendererApplication<Renderer>::LoadScene(const uint32_t sceneIndex)
 {
+    TRACE_ZONE("LoadScene");
+
     std::vector<Assets::Model> models;
     std::vector<Assets::Texture> textures;
     std::vector<Assets::Node> nodes;
     std::vector<Assets::Material> materials;
     std::vector<Assets::LightObject> lights;
 
+    const auto timer = std::chrono::high_resolution_clock::now();
+
     // texture id 0: global sky
     textures.push_back(Assets::Texture::LoadHDRTexture("../assets/textures/StinsonBeach.hdr", Vulkan::SamplerConfig()));
 
@@ -335,22 +719,167 @@ void NextRendererApplication<Renderer>::LoadScene(const uint32_t sceneIndex)
         textures.push_back(Assets::Texture::LoadTexture("../assets/textures/white.png", Vulkan::SamplerConfig()));
     }
 
+    // Texture decoding runs on the thread pool while the scene is parsed, wait for all of it before uploading.
+    Assets::Texture::JoinAll(textures);
+
+    // Share one model (and BLAS) between all the translated copies of it.
+    const auto modelCount = models.size();
+    const auto collapsed = Assets::GeometryDedup::Collapse(nodes, models);
+    if (collapsed != 0)
+    {
+        std::cout << "- collapsed " << collapsed << " of " << modelCount << " models into instances of " << models.size() << " models" << std::endl;
+    }
+
     scene_.reset(new Assets::Scene(Renderer::CommandPool(), std::move(nodes), std::move(models), std::move(textures),
-                                   std::move(materials), std::move(lights), Renderer::supportRayTracing_));
+                                   std::move(materials), std::move(lights), Renderer::supportRayTracing_,
+                                   GOption->CompactVertices));
     sceneIndex_ = sceneIndex;
 
+    const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(
+        std::chrono::high_resolution_clock::now() - timer).count();
+    std::cout << "- loaded scene '" << SceneList::AllScenes[sceneIndex].first << "' in " << elapsed << "s" << std::endl;
+
     userSettings_.FieldOfView = cameraInitialSate_.FieldOfView;
     userSettings_.Aperture = cameraInitialSate_.Aperture;
     userSettings_.FocusDistance = cameraInitialSate_.FocusDistance;
 
     modelViewController_.Reset(cameraInitialSate_.ModelView);
+    PickAnimatedNode();
 
     periodTotalFrames_ = 0;
     benchmarkTotalFrames_ = 0;
+    benchmarkFrameTimes_.clear();
     resetAccumulation_ = true;
     sceneInitialTime_ = Renderer::Window().GetTime();
 }
 
+template <typename Renderer>
+void NextRendererApplication<Renderer>::PickAnimatedNode()
+{
+    animatedNode_ = -1;
+
+    if (!GOption->Animate)
+    {
+        return;
+    }
+
+    // The first node that can move and sits in front of the camera, slid along x by its own width.
+    const auto& nodes = scene_->Nodes();
+    for (uint32_t n = 0; n != nodes.size(); ++n)
+    {
+        if (!scene_->CanMoveNode(n))
+        {
+            continue;
+        }
+
+        const auto& model = scene_->Models()[nodes[n].GetModel()];
+        const glm::vec4 center = nodes[n].WorldTransform() * glm::vec4((model.GetLocalAABBMin() + model.GetLocalAABBMax()) * 0.5f, 1);
+        if ((cameraInitialSate_.ModelView * center).z >= 0)
+        {
+            continue;
+        }
+
+        animatedNode_ = static_cast<int32_t>(n);
+        animatedNodeBase_ = nodes[n].WorldTransform();
+        animatedNodeOffset_ = glm::vec3(model.GetLocalAABBMax().x - model.GetLocalAABBMin().x, 0, 0);
+        std::cout << "- animating node " << n << std::endl;
+        return;
+    }
+
+    Utilities::Console::Write(Utilities::Severity::Warning, [&]()
+    {
+        std::cout << "WARNING: no movable node in view, nothing to animate" << std::endl;
+    });
+}
+
+template <typename Renderer>
+void NextRendererApplication<Renderer>::AnimateNode()
+{
+    if (animatedNode_ < 0)
+    {
+        return;
+    }
+
+    // Headless runs move the node once, so the accumulation can still converge and the result be checked.
+    if (Renderer::Window().Config().Headless)
+    {
+        if (scene_->Nodes()[animatedNode_].WorldTransform() == animatedNodeBase_)
+        {
+            scene_->SetNodeTransform(animatedNode_, glm::translate(glm::mat4(1), animatedNodeOffset_) * animatedNodeBase_);
+        }
+        return;
+    }
+
+    const float phase = static_cast<float>(std::sin(time_));
+    scene_->SetNodeTransform(animatedNode_, glm::translate(glm::mat4(1), animatedNodeOffset_ * phase) * animatedNodeBase_);
+}
+
+template <typename Renderer>
+void NextRendererApplication<Renderer>::CheckAnimatedNode()
+{
+    if (animatedNode_ < 0)
+    {
+        return;
+    }
+
+    const int32_t instance = Renderer::NodeInstance(animatedNode_);
+    const auto hits = Renderer::ReadPrimaryHitInstances();
+    if (instance < 0 || hits.empty())
+    {
+        std::cout << "Animate: " << Renderer::StaticClass() << " keeps no primary hits, node not checked" << std::endl;
+        return;
+    }
+
+    const auto extent = Renderer::SwapChain().Extent();
+    const auto& model = scene_->Models()[scene_->Nodes()[animatedNode_].GetModel()];
+    const glm::vec4 center((model.GetLocalAABBMin() + model.GetLocalAABBMax()) * 0.5f, 1);
+
+    // Same mapping as the motion vectors in the ray generation shader, with the camera of the last frame.
+    const auto project = [&](const glm::mat4& transform)
+    {
+        const glm::vec4 clip = prevUBO_.ViewProjection * transform * center;
+        return (glm::vec2(clip) / clip.w * 0.5f + 0.5f) * glm::vec2(extent.width, extent.height);
+    };
+
+    const glm::vec2 before = project(animatedNodeBase_);
+    const glm::vec2 after = project(scene_->Nodes()[animatedNode_].WorldTransform());
+
+    const bool inView = after.x >= 0 && after.y >= 0 && after.x < extent.width && after.y < extent.height;
+    if (!inView || glm::distance(before, after) < 1.0f)
+    {
+        std::cout << "Animate: node " << animatedNode_ << " did not move within the view, node not checked" << std::endl;
+        return;
+    }
+
+    // The node has only been refitted into the TLAS, its hits have to gather around where it went, not where it was.
+    glm::dvec2 sum(0);
+    size_t count = 0;
+    for (uint32_t y = 0; y != extent.height; ++y)
+    {
+        for (uint32_t x = 0; x != extent.width; ++x)
+        {
+            if (hits[static_cast<size_t>(y) * extent.width + x] == static_cast<uint32_t>(instance))
+            {
+                sum += glm::dvec2(x, y);
+                ++count;
+            }
+        }
+    }
+
+    if (count == 0)
+    {
+        Throw(std::runtime_error("moved node " + std::to_string(animatedNode_) + " is not hit anywhere"));
+    }
+
+    const glm::vec2 centroid = glm::vec2(sum / static_cast<double>(count));
+    if (glm::distance(centroid, after) >= glm::distance(centroid, before))
+    {
+        Throw(std::runtime_error("moved node " + std::to_string(animatedNode_) + " is still hit at its previous position"));
+    }
+
+    std::cout << "Animate: node " << animatedNode_ << " hit at its new position (" << count << " pixels)" << std::endl;
+}
+
 template <typename Renderer>
 void NextRendererApplication<Renderer>::CheckAndUpdateBenchmarkState(double prevTime)
 {
@@ -367,6 +896,7 @@ void NextRendererApplication<Renderer>::CheckAndUpdateBenchmarkState(double prev
         std::cout << "Benchmark: Start scene #" << sceneIndex_ << " '" << SceneList::AllScenes[sceneIndex_].first << "'"
             << std::endl;
         periodInitialTime_ = time_;
+        Renderer::GpuProfiler().ResetTotals();
     }
 
     // Print out the frame rate at regular intervals.
@@ -383,6 +913,12 @@ void NextRendererApplication<Renderer>::CheckAndUpdateBenchmarkState(double prev
             periodTotalFrames_ = 0;
         }
 
+        // The first frame of a scene also covers the scene loading.
+        if (benchmarkTotalFrames_ != 0)
+        {
+            benchmarkFrameTimes_.push_back((time_ - prevTime) * 1000);
+        }
+
         periodTotalFrames_++;
         benchmarkTotalFrames_++;
     }
@@ -415,6 +951,42 @@ void NextRendererApplication<Renderer>::CheckAndUpdateBenchmarkState(double prev
     }
 }
 
+template <typename Renderer>
+void NextRendererApplication<Renderer>::CheckHeadlessLimit()
+{
+    const bool frameLimitReached = GOption->Frames != 0 && totalFrames_ >= GOption->Frames;
+    const bool sampleLimitReached = numberOfSamples_ == 0;
+
+    if (!frameLimitReached && !sampleLimitReached)
+    {
+        return;
+    }
+
+    // The frame just submitted also copied its image into the screenshot memory.
+    Renderer::Device().WaitIdle();
+
+    CheckAnimatedNode();
+
+    auto report = std::make_shared<BenchmarkReport>();
+    report->SceneName = SceneList::AllScenes[sceneIndex_].first;
+    CopyReadback(*Renderer::GetScreenShotMemory(), Renderer::SwapChain().Extent(), userSettings_.PaperWhiteNit, *report);
+
+    std::cout << "Headless: rendered " << totalFrames_ << " frames, " << totalNumberOfSamples_ << " samples per pixel" << std::endl;
+
+    if (!GOption->Reference.empty())
+    {
+        CompareWithReference(*report, GOption->Reference);
+    }
+
+    pendingReports_.push_back(reportWorker_->Submit([report]()
+    {
+        SaveScreenshot(*report);
+        std::cout << "- wrote '" << report->SceneName << ".avif'" << std::endl;
+    }));
+
+    Renderer::Window().Close();
+}
+
 template <typename Renderer>
 void NextRendererApplication<Renderer>::CheckFramebufferSize() const
 {
@@ -437,6 +1009,8 @@ void NextRendererApplication<Renderer>::CheckFramebufferSize() const
 template <typename Renderer>
 void NextRendererApplication<Renderer>::Report(int fps, const std::string& sceneName, bool upload_screen, bool save_screen)
 {
+    TRACE_ZONE("Report");
+
     VkPhysicalDeviceDriverProperties driverProp{};
     driverProp.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DRIVER_PROPERTIES;
 
@@ -446,140 +1020,84 @@ void NextRendererApplication<Renderer>::Report(int fps, const std::string& scene
 
     vkGetPhysicalDeviceProperties2(Renderer::Device().PhysicalDevice(), &deviceProp);
 
-    std::string img_encoded = "";
-    if (upload_screen || save_screen)
+    // Mean GPU milliseconds of each render pass over the benchmarked scene.
+    json11::Json::object gpuTimes;
+    for (const auto& zone : Renderer::GpuProfiler().Zones())
     {
-        // screenshot stuffs
-        const Vulkan::SwapChain& swapChain = Renderer::SwapChain();
-
-        avifImage* image = avifImageCreate(swapChain.Extent().width, swapChain.Extent().height, 10,
-                                           AVIF_PIXEL_FORMAT_YUV444); // these values dictate what goes into the final AVIF
-        if (!image)
-        {
-            Throw(std::runtime_error("avif image creation failed"));
-        }
-        image->yuvRange = AVIF_RANGE_FULL;
-        image->colorPrimaries = AVIF_COLOR_PRIMARIES_BT2020;
-        image->transferCharacteristics = AVIF_TRANSFER_CHARACTERISTICS_SMPTE2084;
-        image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_IDENTITY;
-        image->clli.maxCLL = userSettings_.PaperWhiteNit; //maxCLLNits;
-        image->clli.maxPALL = 0; //maxFALLNits;
-
-        avifEncoder* encoder = NULL;
-        avifRWData avifOutput = AVIF_DATA_EMPTY;
-
-        avifRGBImage rgbAvifImage{};
-        avifRGBImageSetDefaults(&rgbAvifImage, image);
-        rgbAvifImage.format = AVIF_RGB_FORMAT_BGR;
-        rgbAvifImage.ignoreAlpha = AVIF_TRUE;
-
-        //if (  VK_FORMAT_A2R10G10B10_UNORM_PACK32 )
-        uint16_t* data = (uint16_t*)malloc(rgbAvifImage.width * rgbAvifImage.height * 3 * 2);
-        {
-            Vulkan::DeviceMemory* vkMemory = Renderer::GetScreenShotMemory();
-
-            constexpr uint32_t kCompCnt = 3;
-            int imageSize = swapChain.Extent().width * swapChain.Extent().height * kCompCnt;
-
-            uint8_t* mappedData = (uint8_t*)vkMemory->Map(0, imageSize);
-
-            for (uint32_t y = 0; y < swapChain.Extent().height; y++)
-            {
-                for (uint32_t x = 0; x < swapChain.Extent().width; x++)
-                {
-                    uint32_t* pInPixel = (uint32_t*)&mappedData[(y * swapChain.Extent().width * 4) + x * 4];
-                    uint32_t uInPixel = *pInPixel;
-
-                    data[y * swapChain.Extent().width * kCompCnt + x * kCompCnt + 0] = (uInPixel & (0b1111111111 << 20)) >> 20;
-                    data[y * swapChain.Extent().width * kCompCnt + x * kCompCnt + 1] = (uInPixel & (0b1111111111 << 10)) >> 10;
-                    data[y * swapChain.Extent().width * kCompCnt + x * kCompCnt + 2] = (uInPixel & (0b1111111111 << 0)) >> 0;
-                }
-            }
-            vkMemory->Unmap();
-        }
-
-        rgbAvifImage.pixels = (uint8_t*)data;
-        rgbAvifImage.rowBytes = rgbAvifImage.width * 3 * sizeof(uint16_t);
-
-        avifResult convertResult = avifImageRGBToYUV(image, &rgbAvifImage);
-        if (convertResult != AVIF_RESULT_OK)
-        {
-            Throw(std::runtime_error("Failed to convert RGB to YUV: " + std::string(avifResultToString(convertResult))));
-        }
-        encoder = avifEncoderCreate();
-        if (!encoder)
+        if (zone.Samples != 0)
         {
-            Throw(std::runtime_error("Failed to create encoder"));
-        }
-        encoder->quality = 80;
-        encoder->qualityAlpha = AVIF_QUALITY_LOSSLESS;
-        encoder->speed = AVIF_SPEED_FASTEST;
-
-        avifResult addImageResult = avifEncoderAddImage(encoder, image, 1, AVIF_ADD_IMAGE_FLAG_SINGLE);
-        if (addImageResult != AVIF_RESULT_OK)
-        {
-            Throw(std::runtime_error("Failed to add image: " + std::string(avifResultToString(addImageResult))));
-        }
-        avifResult finishResult = avifEncoderFinish(encoder, &avifOutput);
-        if (finishResult != AVIF_RESULT_OK)
-        {
-            Throw(std::runtime_error("Failed to finish encoding: " + std::string(avifResultToString(finishResult))));
-        }
-        free(data);
-
-        // save to file with scenename
-        std::string filename = sceneName + ".avif";
-        FILE* f = fopen(filename.c_str(), "wb");
-        if (!f)
-        {
-            Throw(std::runtime_error("Failed to open file for writing"));
+            gpuTimes[zone.Name] = zone.TotalMs / zone.Samples;
         }
-        fwrite(avifOutput.data, 1, avifOutput.size, f);
-        fclose(f);
-        
-        
-        // send to server
-        //img_encoded = base64_encode(avifOutput.data, avifOutput.size, false);
     }
 
+    const auto frameStats = ComputeFrameTimeStatistics(benchmarkFrameTimes_);
+    const auto extent = Renderer::SwapChain().Extent();
+
+    std::cout << "Benchmark: frame time p50 " << frameStats.P50 << " ms, p95 " << frameStats.P95 << " ms, p99 "
+        << frameStats.P99 << " ms, " << frameStats.Stutters << " stutters" << std::endl;
 
     json11::Json my_json = json11::Json::object{
         {"renderer", Renderer::StaticClass()},
         {"scene", sceneName},
         {"gpu", std::string(deviceProp.properties.deviceName)},
         {"driver", std::string(driverProp.driverInfo)},
+        {"driver_version", std::to_string(deviceProp.properties.driverVersion)},
+        {"resolution", std::to_string(extent.width) + "x" + std::to_string(extent.height)},
         {"fps", fps},
+        {"frames", static_cast<int>(benchmarkFrameTimes_.size())},
+        {"frame_time_ms", json11::Json::object{
+            {"min", frameStats.Min},
+            {"avg", frameStats.Avg},
+            {"p50", frameStats.P50},
+            {"p95", frameStats.P95},
+            {"p99", frameStats.P99},
+            {"max", frameStats.Max},
+        }},
+        {"stutters", static_cast<int>(frameStats.Stutters)},
+        {"samples_per_pixel", static_cast<int>(totalNumberOfSamples_)},
+        {"sky_sampling", userSettings_.SampleSky},
+        {"gpu_times", gpuTimes},
     };
-    std::string json_str = my_json.dump();
 
-    std::cout << "Sending benchmark to perf server..." << std::endl;
-    // upload from curl
-    CURL* curl;
-    CURLcode res;
-    curl_global_init(CURL_GLOBAL_ALL);
-    curl = curl_easy_init();
-    if (curl)
+    auto report = std::make_shared<BenchmarkReport>();
+    report->SceneName = sceneName;
+    report->Json = my_json.dump();
+    report->FrameTimes = benchmarkFrameTimes_;
+    report->Upload = GOption->BenchmarkUpload;
+
+    if (upload_screen || save_screen)
     {
-        curl_slist* slist1 = nullptr;
-        slist1 = curl_slist_append(slist1, "Content-Type: application/json");
-        slist1 = curl_slist_append(slist1, "Accept: application/json");
+        CopyReadback(*Renderer::GetScreenShotMemory(), extent, userSettings_.PaperWhiteNit, *report);
+    }
 
-        /* set custom headers */
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, slist1);
+    CollectReports(false);
+    pendingReports_.push_back(reportWorker_->Submit([report]() { ProcessReport(*report); }));
+}
 
-        curl_easy_setopt(curl, CURLOPT_URL, "http://gameknife.site:60010/rt_benchmark");
-        //curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, avifOutput.size);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_str.c_str());
+template <typename Renderer>
+void NextRendererApplication<Renderer>::CollectReports(const bool wait)
+{
+    for (auto it = pendingReports_.begin(); it != pendingReports_.end();)
+    {
+        if (!wait && it->wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
 
-        /* Perform the request, res gets the return code */
-        res = curl_easy_perform(curl);
-        /* Check for errors */
-        if (res != CURLE_OK)
-            fprintf(stderr, "curl_easy_perform() failed: %s\n",
-                    curl_easy_strerror(res));
+        try
+        {
+            it->get();
+        }
+        catch (const std::exception& exception)
+        {
+            Utilities::Console::Write(Utilities::Severity::Warning, [&exception]()
+            {
+                std::cout << "WARNING: benchmark report failed: " << exception.what() << std::endl;
+            });
+        }
 
-        /* always cleanup */
-        curl_easy_cleanup(curl);
+        it = pendingReports_.erase(it);
     }
 }
 
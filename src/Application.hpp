@@ -8,6 +8,12 @@
 #include "Vulkan/LegacyDeferred/LegacyDeferredRenderer.hpp"
 #include "Assets/UniformBuffer.hpp"
 #include "Assets/Model.hpp"
+#include <future>
+
+namespace Utilities
+{
+	class ThreadPool;
+}
 
 template <typename Renderer>
 class NextRendererApplication final : public Renderer
@@ -45,9 +51,15 @@ private:
 
 	void LoadScene(uint32_t sceneIndex);
 	void CheckAndUpdateBenchmarkState(double prevTime);
+	void CheckHeadlessLimit();
+	void PickAnimatedNode();
+	void AnimateNode();
+	void CheckAnimatedNode();
 	void CheckFramebufferSize() const;
 
+	// Hands the report over to the report worker, encoding and upload never block the render thread.
 	void Report(int fps, const std::string& sceneName, bool upload_screen, bool save_screen);
+	void CollectReports(bool wait);
 
 	uint32_t sceneIndex_{};
 	UserSettings userSettings_{};
@@ -57,7 +69,7 @@ private:
 
 	mutable Assets::UniformBufferObject prevUBO_ {};
 
-	std::unique_ptr<const Assets::Scene> scene_;
+	std::unique_ptr<Assets::Scene> scene_;
 	std::unique_ptr<class UserInterface> userInterface_;
 
 	double time_{};
@@ -67,9 +79,19 @@ private:
 	uint32_t numberOfSamples_{};
 	bool resetAccumulation_{};
 
+	// --animate: the node slid by AnimateNode(), -1 when there is none.
+	int32_t animatedNode_{-1};
+	glm::mat4 animatedNodeBase_{};
+	glm::vec3 animatedNodeOffset_{};
+
 	// Benchmark stats
 	double sceneInitialTime_{};
 	double periodInitialTime_{};
 	uint32_t periodTotalFrames_{};
 	uint32_t benchmarkTotalFrames_{};
+	std::vector<double> benchmarkFrameTimes_;
+
+	// Single thread, so reports are processed in the order the scenes finished.
+	std::unique_ptr<Utilities::ThreadPool> reportWorker_;
+	std::vector<std::future<void>> pendingReports_;
 };
@@ -0,0 +1,73 @@
+#include "AliasTable.hpp"
+
+#include <cmath>
+
+namespace Assets
+{
+    std::vector<AliasEntry> AliasTable::Build(const std::vector<float>& weights)
+    {
+        const size_t count = weights.size();
+        std::vector<AliasEntry> table(count);
+
+        if (count == 0)
+        {
+            return table;
+        }
+
+        double sum = 0;
+        for (const float weight : weights)
+        {
+            sum += std::isfinite(weight) && weight > 0 ? weight : 0;
+        }
+
+        // Scaled so that the average slot holds exactly 1.
+        std::vector<double> scaled(count);
+        for (size_t i = 0; i != count; ++i)
+        {
+            const double weight = std::isfinite(weights[i]) && weights[i] > 0 ? weights[i] : 0;
+            const double pdf = sum > 0 ? weight / sum : 1.0 / count;
+
+            table[i].Pdf = static_cast<float>(pdf);
+            table[i].Alias = static_cast<uint32_t>(i);
+            scaled[i] = pdf * count;
+        }
+
+        std::vector<uint32_t> small;
+        std::vector<uint32_t> large;
+        small.reserve(count);
+        large.reserve(count);
+
+        for (size_t i = 0; i != count; ++i)
+        {
+            (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+        }
+
+        // Each small slot is topped up by a large one, which then goes back to the list it now belongs to.
+        while (!small.empty() && !large.empty())
+        {
+            const uint32_t less = small.back();
+            const uint32_t more = large.back();
+            small.pop_back();
+            large.pop_back();
+
+            table[less].Threshold = static_cast<float>(scaled[less]);
+            table[less].Alias = more;
+
+            scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+            (scaled[more] < 1.0 ? small : large).push_back(more);
+        }
+
+        // Whatever is left only differs from 1 by rounding.
+        for (const uint32_t i : large)
+        {
+            table[i].Threshold = 1.0f;
+        }
+
+        for (const uint32_t i : small)
+        {
+            table[i].Threshold = 1.0f;
+        }
+
+        return table;
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Assets
+{
+    // One slot of an alias table, laid out as AliasEntry in Material.glsl.
+    // A uniformly picked slot keeps its own index with probability Threshold and takes Alias otherwise.
+    struct AliasEntry final
+    {
+        float Threshold;
+        uint32_t Alias;
+        // Probability of ending up on this index, weight / sum of all weights.
+        float Pdf;
+        uint32_t Reserved;
+    };
+
+    // Walker's alias method (Vose's variant), draws an index proportionally to its weight with two random
+    // numbers and a single table read.
+    class AliasTable final
+    {
+    public:
+        // Negative and non finite weights count as zero. If every weight is zero the table is uniform.
+        static std::vector<AliasEntry> Build(const std::vector<float>& weights);
+    };
+}
@@ -0,0 +1,183 @@
+#include "GeometryDedup.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace Assets
+{
+    namespace
+    {
+        struct Instance
+        {
+            uint32_t Model;
+            glm::vec3 Translation;
+            int32_t MaterialOffset;
+        };
+
+        uint64_t Mix(uint64_t hash, uint32_t value)
+        {
+            // FNV-1a over 32-bit words.
+            hash ^= value;
+            hash *= 0x100000001b3ull;
+            return hash;
+        }
+
+        template <class T>
+        uint64_t MixBits(uint64_t hash, const T& value)
+        {
+            static_assert(sizeof(T) % sizeof(uint32_t) == 0, "Hashed as a sequence of 32-bit words");
+
+            uint32_t words[sizeof(T) / sizeof(uint32_t)];
+            std::memcpy(words, &value, sizeof(T));
+            for (const uint32_t word : words)
+            {
+                hash = Mix(hash, word);
+            }
+
+            return hash;
+        }
+
+        // Everything that has to match exactly between two copies. Positions and material indices
+        // are left out since they differ by the translation / material offset.
+        uint64_t HashGeometry(const Model& model)
+        {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            hash = Mix(hash, model.NumberOfVertices());
+            hash = Mix(hash, model.NumberOfIndices());
+
+            for (const uint32_t index : model.Indices())
+            {
+                hash = Mix(hash, index);
+            }
+
+            for (const auto& vertex : model.Vertices())
+            {
+                hash = MixBits(hash, vertex.Normal);
+                hash = MixBits(hash, vertex.TexCoord);
+            }
+
+            return hash;
+        }
+
+        bool IsTranslatedCopy(const Model& base, const Model& copy, glm::vec3& translation, int32_t& materialOffset)
+        {
+            const auto& a = base.Vertices();
+            const auto& b = copy.Vertices();
+
+            if (a.size() != b.size() || base.Indices() != copy.Indices())
+            {
+                return false;
+            }
+
+            translation = b[0].Position - a[0].Position;
+            materialOffset = b[0].MaterialIndex - a[0].MaterialIndex;
+
+            // Positions are baked as 'center + offset', allow for the rounding of that addition.
+            const glm::vec3 extent = glm::abs(base.GetLocalAABBMax() - base.GetLocalAABBMin());
+            const float scale = 1.0f + std::max(extent.x, std::max(extent.y, extent.z)) +
+                std::max(std::abs(translation.x), std::max(std::abs(translation.y), std::abs(translation.z)));
+            const float tolerance = 1e-5f * scale;
+
+            const auto isTranslated = [&](const glm::vec3& from, const glm::vec3& to)
+            {
+                const glm::vec3 error = glm::abs(to - from - translation);
+                return error.x <= tolerance && error.y <= tolerance && error.z <= tolerance;
+            };
+
+            for (size_t i = 0; i != a.size(); ++i)
+            {
+                if (!isTranslated(a[i].Position, b[i].Position) ||
+                    b[i].MaterialIndex - a[i].MaterialIndex != materialOffset ||
+                    std::memcmp(&a[i].Normal, &b[i].Normal, sizeof(glm::vec3)) != 0 ||
+                    std::memcmp(&a[i].TexCoord, &b[i].TexCoord, sizeof(glm::vec2)) != 0)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    }
+
+    uint32_t GeometryDedup::Collapse(std::vector<Node>& nodes, std::vector<Model>& models)
+    {
+        std::vector<Instance> instances(models.size());
+        std::unordered_map<uint64_t, std::vector<uint32_t>> buckets;
+        uint32_t collapsed = 0;
+
+        for (uint32_t i = 0; i != models.size(); ++i)
+        {
+            auto& instance = instances[i];
+            instance = Instance{i, glm::vec3(0), 0};
+
+            // Procedural shapes are intersected in world space, they keep their own model.
+            if (models[i].NumberOfVertices() == 0 || models[i].Procedural() != nullptr)
+            {
+                continue;
+            }
+
+            auto& bucket = buckets[HashGeometry(models[i])];
+            const auto match = std::find_if(bucket.begin(), bucket.end(), [&](const uint32_t candidate)
+            {
+                return IsTranslatedCopy(models[candidate], models[i], instance.Translation, instance.MaterialOffset);
+            });
+
+            if (match != bucket.end())
+            {
+                instance.Model = *match;
+                ++collapsed;
+            }
+            else
+            {
+                instance.Translation = glm::vec3(0);
+                instance.MaterialOffset = 0;
+                bucket.push_back(i);
+            }
+        }
+
+        if (collapsed == 0)
+        {
+            return 0;
+        }
+
+        // Drop the copies and renumber the remaining models.
+        std::vector<int> remap(models.size(), -1);
+        std::vector<Model> kept;
+        kept.reserve(models.size() - collapsed);
+
+        for (uint32_t i = 0; i != models.size(); ++i)
+        {
+            if (instances[i].Model == i)
+            {
+                remap[i] = static_cast<int>(kept.size());
+                kept.push_back(std::move(models[i]));
+            }
+        }
+
+        std::vector<Node> rewritten;
+        rewritten.reserve(nodes.size());
+
+        for (const auto& node : nodes)
+        {
+            const int id = node.GetModel();
+            if (id < 0 || id >= static_cast<int>(instances.size()))
+            {
+                rewritten.push_back(node);
+                continue;
+            }
+
+            const auto& instance = instances[id];
+            Node shared = Node::CreateNode(node.WorldTransform() * glm::translate(glm::mat4(1), instance.Translation),
+                                           remap[instance.Model], node.IsProcedural());
+            shared.MaterialOffset(node.GetMaterialOffset() + instance.MaterialOffset);
+            rewritten.push_back(shared);
+        }
+
+        models.swap(kept);
+        nodes.swap(rewritten);
+
+        return collapsed;
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Model.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace Assets
+{
+    // Finds models that are translated copies of an earlier model (same topology, normals and uvs,
+    // positions shifted by a constant and material indices shifted by a constant) and rewrites the
+    // nodes using them to reference the earlier model instead, with the translation folded into the
+    // node transform and the material shift stored as the node material offset.
+    // Collapsed models are removed, so the renderers build one BLAS / issue one instanced draw for all of them.
+    class GeometryDedup final
+    {
+    public:
+        // Returns the number of models removed.
+        static uint32_t Collapse(std::vector<Node>& nodes, std::vector<Model>& models);
+    };
+}
@@ -1,20 +1,25 @@
 #include "Model.hpp"
 #include "CornellBox.hpp"
 #include "Procedural.hpp"
+#include "SceneCache.hpp"
 #include "Sphere.hpp"
+#include "VertexWelder.hpp"
 #include "Utilities/Exception.hpp"
 #include "Utilities/Console.hpp"
+#include "Utilities/Tracer.hpp"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/matrix_inverse.hpp>
-#include <glm/gtx/hash.hpp>
 #include <glm/gtx/quaternion.hpp>
 
 #include <tiny_obj_loader.h>
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
-#include <unordered_map>
+#include <limits>
+#include <sstream>
 #include <vector>
 
 #define TINYGLTF_IMPLEMENTATION
@@ -23,37 +28,46 @@
 #include <tiny_gltf.h>
 
 #include "Texture.hpp"
-
-#define FLATTEN_VERTICE 1
+#include "Options.hpp"
 
 using namespace glm;
 
-namespace std
+namespace
 {
-    template <>
-    struct hash<Assets::Vertex> final
+    bool flattenVerticesRequired = false;
+
+    // tinyobj does not report which material libraries it read, so the 'mtllib' statements are
+    // collected here for the scene cache. Libraries are resolved next to the .obj, as tinyobj does.
+    std::vector<std::string> FindMaterialLibraries(const std::string& filename)
     {
-        size_t operator()(Assets::Vertex const& vertex) const noexcept
+        const std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+        std::vector<std::string> libraries;
+        std::ifstream in(filename);
+        std::string line;
+        while (std::getline(in, line))
         {
-            return
-                Combine(hash<vec3>()(vertex.Position),
-                        Combine(hash<vec3>()(vertex.Normal),
-                                Combine(hash<vec2>()(vertex.TexCoord),
-                                        hash<int>()(vertex.MaterialIndex))));
-        }
+            std::istringstream tokens(line);
+            std::string keyword;
+            if (!(tokens >> keyword) || keyword != "mtllib")
+            {
+                continue;
+            }
 
-    private:
-        static size_t Combine(size_t hash0, size_t hash1)
-        {
-            return hash0 ^ (hash1 + 0x9e3779b9 + (hash0 << 6) + (hash0 >> 2));
+            std::string library;
+            while (tokens >> library)
+            {
+                libraries.push_back((directory / library).string());
+            }
         }
-    };
+
+        return libraries;
+    }
 }
 
 namespace Assets
 {
     void ParseGltfNode(std::vector<Assets::Node>& out_nodes, Assets::CameraInitialSate& out_camera, std::vector<Assets::LightObject>& out_lights,
-        glm::mat4 parentTransform, tinygltf::Model& model, int node_idx)
+        glm::mat4 parentTransform, tinygltf::Model& model, int node_idx, int material_offset)
     {
         tinygltf::Node& node = model.nodes[node_idx];
             
@@ -83,13 +97,19 @@ namespace Assets
                 glm::vec4 local_p1 = glm::vec4(-1,0,1, 1);
                 glm::vec4 local_p3 = glm::vec4(1,0,-1, 1);
                 
-                LightObject light;
+                LightObject light {};
                 light.p0 = transform * local_p0;
                 light.p1 = transform * local_p1;
                 light.p3 = transform * local_p3;
                 vec3 dir = vec3(transform * glm::vec4(0,1,0,0));
                 light.normal_area = glm::vec4(glm::normalize(dir),0);
-                light.normal_area.w = glm::length(glm::cross(glm::vec3(light.p1 - light.p0), glm::vec3(light.p3 - light.p0))) / 2.0f;
+                // the quad is the parallelogram spanned by p1 - p0 and p3 - p0, the full cross product length is its area
+                light.normal_area.w = glm::length(glm::cross(glm::vec3(light.p1 - light.p0), glm::vec3(light.p3 - light.p0)));
+
+                const auto& primitives = model.meshes[node.mesh].primitives;
+                light.material_index = primitives.empty() || primitives[0].material < 0
+                                           ? std::numeric_limits<uint32_t>::max()
+                                           : static_cast<uint32_t>(primitives[0].material + material_offset);
                 
                 out_lights.push_back(light);
             }
@@ -110,7 +130,7 @@ namespace Assets
 
         for ( int child : node.children )
         {
-            ParseGltfNode(out_nodes, out_camera, out_lights, transform, model, child);
+            ParseGltfNode(out_nodes, out_camera, out_lights, transform, model, child, material_offset);
         }
     }
     
@@ -118,8 +138,28 @@ namespace Assets
                               std::vector<Assets::Model>& models, std::vector<Assets::Texture>& textures,
                               std::vector<Assets::Material>& materials, std::vector<Assets::LightObject>& lights)
     {
+        TRACE_ZONE("LoadGLTFScene");
+
         int matieralIdx = materials.size();
         int textureIdx = textures.size();
+
+        std::cout << "- loading '" << filename << "'... " << std::flush;
+        const auto timer = std::chrono::high_resolution_clock::now();
+
+        const SceneCache::Base cacheBase = SceneCache::Snapshot(nodes, models, textures, materials, lights);
+        const uint32_t cacheVariant = ShouldFlattenVertices() ? 2 : 0;
+        if (SceneCache::Load(filename, cacheVariant, &cameraInit, nodes, models, textures, materials, lights))
+        {
+            const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(
+                std::chrono::high_resolution_clock::now() - timer).count();
+            std::cout << "(cached, " << models.size() - cacheBase.Models << " models, "
+                << materials.size() - cacheBase.Materials << " materials) " << elapsed << "s" << std::endl;
+            return;
+        }
+        std::cout << std::endl;
+
+        std::vector<SceneCache::TextureSource> textureSources;
+        std::vector<std::string> cacheDependencies;
         
         tinygltf::Model model;
         tinygltf::TinyGLTF gltfLoader;
@@ -131,6 +171,14 @@ namespace Assets
             return;
         }
 
+        // external buffers invalidate the scene cache just like the source
+        for (const tinygltf::Buffer& buffer : model.buffers)
+        {
+            if (!buffer.uri.empty() && buffer.uri.rfind("data:", 0) != 0)
+            {
+                cacheDependencies.push_back((std::filesystem::path(filename).parent_path() / buffer.uri).string());
+            }
+        }
 
         // load all lights
         for (tinygltf::Camera& cam : model.cameras)
@@ -144,9 +192,19 @@ namespace Assets
         for (tinygltf::Image& image : model.images)
         {
             // 假设，这里的image id和外面的textures id是一样的
-            textures.push_back(Texture::LoadTexture(
-                image.name, model.buffers[0].data.data() + model.bufferViews[image.bufferView].byteOffset,
-                model.bufferViews[image.bufferView].byteLength, Vulkan::SamplerConfig()));
+            if (image.bufferView < 0 && !image.uri.empty() && image.uri.rfind("data:", 0) != 0)
+            {
+                const std::string loadname = (std::filesystem::path(filename).parent_path() / image.uri).string();
+                textures.push_back(Texture::LoadTexture(loadname, Vulkan::SamplerConfig()));
+                textureSources.push_back({loadname, {}});
+                cacheDependencies.push_back(loadname);
+                continue;
+            }
+
+            const unsigned char* encoded = model.buffers[0].data.data() + model.bufferViews[image.bufferView].byteOffset;
+            const size_t encodedLength = model.bufferViews[image.bufferView].byteLength;
+            textures.push_back(Texture::LoadTexture(image.name, encoded, encodedLength, Vulkan::SamplerConfig()));
+            textureSources.push_back({image.name, std::vector<unsigned char>(encoded, encoded + encodedLength)});
         }
 
         // load all materials
@@ -255,17 +313,36 @@ namespace Assets
                 }
             }
 
-            #if FLATTEN_VERTICE
+            if (ShouldFlattenVertices())
+            {
                 FlattenVertices(vertices, indices);
-            #endif
+            }
 
             models.push_back(Assets::Model(std::move(vertices), std::move(indices), nullptr));
         }
 
         for (int nodeIdx : model.scenes[0].nodes)
         {
-            ParseGltfNode(nodes, cameraInit, lights, glm::mat4(1), model, nodeIdx);
+            ParseGltfNode(nodes, cameraInit, lights, glm::mat4(1), model, nodeIdx, matieralIdx);
         }
+
+        SceneCache::Save(filename, cacheVariant, cacheDependencies, cacheBase, &cameraInit, nodes, models, textureSources, materials, lights);
+
+        const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(
+            std::chrono::high_resolution_clock::now() - timer).count();
+        std::cout << "- parsed '" << filename << "' (" << models.size() - cacheBase.Models << " models, "
+            << materials.size() - cacheBase.Materials << " materials) " << elapsed << "s" << std::endl;
+    }
+
+    bool Model::ShouldFlattenVertices()
+    {
+        // Indexed geometry is the default, the flattened layout (one vertex per index) is kept as a fallback.
+        return flattenVerticesRequired || (GOption != nullptr && GOption->FlattenVertices);
+    }
+
+    void Model::RequireFlattenedVertices()
+    {
+        flattenVerticesRequired = true;
     }
 
     void Model::FlattenVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
@@ -289,6 +366,8 @@ namespace Assets
                                      std::vector<Material>& materials,
                                      std::vector<LightObject>& lights, bool autoNode)
     {
+        TRACE_ZONE("LoadModel");
+
         int materialIdxOffset = materials.size();
         
         std::cout << "- loading '" << filename << "'... " << std::flush;
@@ -296,6 +375,17 @@ namespace Assets
         const auto timer = std::chrono::high_resolution_clock::now();
         const std::string materialPath = std::filesystem::path(filename).parent_path().string();
 
+        const uint32_t cacheVariant = (autoNode ? 1 : 0) | (ShouldFlattenVertices() ? 2 : 0);
+        const SceneCache::Base cacheBase = SceneCache::Snapshot(nodes, models, textures, materials, lights);
+        if (SceneCache::Load(filename, cacheVariant, nullptr, nodes, models, textures, materials, lights))
+        {
+            const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(
+                std::chrono::high_resolution_clock::now() - timer).count();
+            std::cout << "(cached, " << models.size() - cacheBase.Models << " models, "
+                << materials.size() - cacheBase.Materials << " materials) " << elapsed << "s" << std::endl;
+            return models.size() - 1;
+        }
+
         tinyobj::ObjReader objReader;
 
         if (!objReader.ParseFromFile(filename))
@@ -311,6 +401,9 @@ namespace Assets
             });
         }
 
+        std::vector<SceneCache::TextureSource> textureSources;
+        std::vector<std::string> cacheDependencies = FindMaterialLibraries(filename);
+
         for (const auto& _material : objReader.GetMaterials())
         {
             tinyobj::material_t material = _material;
@@ -326,6 +419,11 @@ namespace Assets
 
                 // find if textures contain texture with loadname equals diffuse_texname
                 std::string loadname = "../assets/textures/" + material.diffuse_texname;
+                if (std::find(cacheDependencies.begin(), cacheDependencies.end(), loadname) == cacheDependencies.end())
+                {
+                    cacheDependencies.push_back(loadname);
+                }
+
                 for (size_t i = 0; i < textures.size(); i++)
                 {
                     if (textures[i].Loadname() == loadname)
@@ -338,6 +436,7 @@ namespace Assets
                 if (m.DiffuseTextureId == -1)
                 {
                     textures.push_back(Texture::LoadTexture(loadname, Vulkan::SamplerConfig()));
+                    textureSources.push_back({loadname, {}});
                     m.DiffuseTextureId = static_cast<int32_t>(textures.size()) - 1;
                 }
             }
@@ -358,8 +457,8 @@ namespace Assets
 
             if (material.emission[0] > 0)
             {
+                // the scene turns the triangles using it into lights
                 m = Material::DiffuseLight(vec3(material.emission[0], material.emission[1], material.emission[2]) * 100.f);
-                // add to lights
             }
 
             if (material.metallic > .99f)
@@ -384,7 +483,8 @@ namespace Assets
 
         // Geometry
         const auto& objAttrib = objReader.GetAttrib();
-        std::unordered_map<Vertex, uint32_t> uniqueVertices(objAttrib.vertices.size());
+        const auto weldTimer = std::chrono::high_resolution_clock::now();
+        size_t uniqueVertexCount = 0;
 
         // add Geometry one by one
         for (const auto& shape : objReader.GetShapes())
@@ -397,6 +497,10 @@ namespace Assets
             glm::vec3 direction(0, 0, 0);
 
             const auto& mesh = shape.mesh;
+            VertexWelder welder(vertices);
+            welder.Reserve(mesh.indices.size());
+            indices.reserve(mesh.indices.size());
+
             size_t faceId = 0;
             for (const auto& index : mesh.indices)
             {
@@ -435,15 +539,11 @@ namespace Assets
 
                 vertex.MaterialIndex = std::max(0, mesh.material_ids[faceId++ / 3] + materialIdxOffset);
 
-                if (uniqueVertices.count(vertex) == 0)
-                {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                    vertices.push_back(vertex);
-                }
-
-                indices.push_back(uniqueVertices[vertex]);
+                indices.push_back(welder.Weld(vertex));
             }
 
+            uniqueVertexCount += vertices.size();
+
             // If the model did not specify normals, then create smooth normals that conserve the same number of vertices.
             // Using flat normals would mean creating more vertices than we currently have, so for simplicity and better visuals we don't do it.
             // See https://stackoverflow.com/questions/12139840/obj-file-averaging-normals.
@@ -473,9 +573,10 @@ namespace Assets
                 continue;
             }
             // flatten the vertice and indices, individual vertice
-#if FLATTEN_VERTICE
-            FlattenVertices(vertices, indices);
-#endif
+            if (ShouldFlattenVertices())
+            {
+                FlattenVertices(vertices, indices);
+            }
 
             models.push_back(Model(std::move(vertices), std::move(indices), nullptr));
             if(autoNode)
@@ -484,11 +585,16 @@ namespace Assets
             }
         }
         
+        const auto weldElapsed = std::chrono::duration<float, std::chrono::seconds::period>(
+            std::chrono::high_resolution_clock::now() - weldTimer).count();
+
+        SceneCache::Save(filename, cacheVariant, cacheDependencies, cacheBase, nullptr, nodes, models, textureSources, materials, lights);
+
         const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(
             std::chrono::high_resolution_clock::now() - timer).count();
 
-        std::cout << "(" << objAttrib.vertices.size() << " vertices, " << uniqueVertices.size() << " unique vertices, "
-            << materials.size() << " materials, " << lights.size() << " lights";
+        std::cout << "(" << objAttrib.vertices.size() << " vertices, " << uniqueVertexCount << " unique vertices, "
+            << materials.size() << " materials, " << lights.size() << " lights, geometry " << weldElapsed << "s) ";
         std::cout << elapsed << "s" << std::endl;
 
         return models.size() - 1;
@@ -504,9 +610,10 @@ namespace Assets
 
         CornellBox::Create(scale, vertices, indices, materials, lights);
 
-#if FLATTEN_VERTICE
-        FlattenVertices(vertices, indices);
-#endif
+        if (ShouldFlattenVertices())
+        {
+            FlattenVertices(vertices, indices);
+        }
 
         models.push_back(Model(
             std::move(vertices),
@@ -562,9 +669,10 @@ namespace Assets
             20, 21, 22, 20, 22, 23
         };
 
-#if FLATTEN_VERTICE
-        FlattenVertices(vertices, indices);
-#endif
+        if (ShouldFlattenVertices())
+        {
+            FlattenVertices(vertices, indices);
+        }
 
         return Model(
             std::move(vertices),
@@ -636,9 +744,10 @@ namespace Assets
         }
 
 
-#if FLATTEN_VERTICE
-        FlattenVertices(vertices, indices);
-#endif
+        if (ShouldFlattenVertices())
+        {
+            FlattenVertices(vertices, indices);
+        }
 
         return Model(
             std::move(vertices),
@@ -671,18 +780,20 @@ namespace Assets
         indices.push_back(2);
         indices.push_back(3);
         
-        LightObject light;
+        LightObject light {};
         light.p0 = vec4(p0,1);
         light.p1 = vec4(p1,1);
         light.p3 = vec4(p3,1);
         light.normal_area = vec4(dir, 0);
-        light.normal_area.w = glm::length(glm::cross(glm::vec3(light.p1 - light.p0), glm::vec3(light.p3 - light.p0))) / 2.0f;
+        light.normal_area.w = glm::length(glm::cross(glm::vec3(light.p1 - light.p0), glm::vec3(light.p3 - light.p0)));
+        light.material_index = materialIdx;
         
         lights.push_back(light);
 
-#if FLATTEN_VERTICE
-        FlattenVertices(vertices, indices);
-#endif
+        if (ShouldFlattenVertices())
+        {
+            FlattenVertices(vertices, indices);
+        }
 
         models.push_back( Model(
             std::move(vertices),
@@ -709,6 +820,15 @@ namespace Assets
         }
     }
 
+    Model::Model(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices,
+                 const glm::vec3& aabbMin, const glm::vec3& aabbMax) :
+        vertices_(std::move(vertices)),
+        indices_(std::move(indices)),
+        local_aabb_min(aabbMin),
+        local_aabb_max(aabbMax)
+    {
+    }
+
     Node Node::CreateNode(glm::mat4 transform, int id, bool procedural)
     {
         return Node(transform, id, procedural);
@@ -26,6 +26,9 @@ namespace Assets
     struct alignas(16) NodeProxy final
 	{
         glm::mat4 transform;
+        uint32_t modelId;
+        int32_t materialOffset;
+        uint32_t reserved[2];
     };
 
     class Node final
@@ -45,11 +48,16 @@ namespace Assets
         int GetModel() const { return modelId_; }
         bool IsProcedural() const { return procedural_; }
 
+        // Added to the material index of every vertex, lets nodes share a model with different materials.
+        void MaterialOffset(int offset) { materialOffset_ = offset; }
+        int GetMaterialOffset() const { return materialOffset_; }
+
     private:
         Node(glm::mat4 transform, int id, bool procedural);
 
         glm::mat4 transform_;
         int modelId_;
+        int materialOffset_{};
         bool procedural_;
     };
     
@@ -57,6 +65,9 @@ namespace Assets
     {
     public:
         static void FlattenVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+        static bool ShouldFlattenVertices();
+        // For renderers that cannot address indexed triangles, must be called before any model is loaded.
+        static void RequireFlattenedVertices();
         static int LoadModel(const std::string& filename, std::vector<Node>& nodes, std::vector<Model>& models,
                                         std::vector<Texture>& textures,
                                      std::vector<Material>& materials,
@@ -93,11 +104,14 @@ namespace Assets
         uint32_t NumberOfVertices() const { return static_cast<uint32_t>(vertices_.size()); }
         uint32_t NumberOfIndices() const { return static_cast<uint32_t>(indices_.size()); }
 
-        glm::vec3 GetLocalAABBMin() {return local_aabb_min;}
-        glm::vec3 GetLocalAABBMax() {return local_aabb_max;}
+        glm::vec3 GetLocalAABBMin() const {return local_aabb_min;}
+        glm::vec3 GetLocalAABBMax() const {return local_aabb_max;}
 
     private:
+        friend class SceneCache;
+
         Model(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices, const class Procedural* procedural);
+        Model(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices, const glm::vec3& aabbMin, const glm::vec3& aabbMax);
 
         std::vector<Vertex> vertices_;
         std::vector<uint32_t> indices_;
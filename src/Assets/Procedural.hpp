@@ -1,10 +1,28 @@
 #pragma once
 
 #include "Utilities/Glm.hpp"
+#include <cstdint>
 #include <utility>
 
 namespace Assets
 {
+	// Every procedural shape has an entry in the ProceduralRegistry, the type is stored
+	// in the GPU record so the shaders can tell the shapes apart.
+	enum class ProceduralType : uint32_t
+	{
+		Sphere = 0,
+		Count
+	};
+
+	// One world space procedural primitive as read by the intersection / hit shaders,
+	// see ProceduralPrimitive in Procedural.glsl.
+	struct ProceduralPrimitive final
+	{
+		glm::vec4 Data;
+		uint32_t Type;
+		int32_t MaterialIndex;
+		uint32_t Reserved[2];
+	};
 
 	class Procedural
 	{
@@ -15,8 +33,14 @@ namespace Assets
 		Procedural& operator = (const Procedural&) = delete;
 		Procedural& operator = (Procedural&&) = delete;
 
-		Procedural() = default;
-		virtual ~Procedural() = default;;
+		explicit Procedural(const ProceduralType type) : type_(type) {}
+		virtual ~Procedural() = default;
 		virtual std::pair<glm::vec3, glm::vec3> BoundingBox() const = 0;
+
+		ProceduralType Type() const { return type_; }
+
+	private:
+
+		const ProceduralType type_;
 	};
 }
@@ -0,0 +1,44 @@
+#include "ProceduralRegistry.hpp"
+#include "Sphere.hpp"
+#include "Utilities/Exception.hpp"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace Assets {
+
+namespace
+{
+	ProceduralPrimitive PackSphere(const Procedural& procedural, const glm::mat4& world)
+	{
+		const auto& sphere = static_cast<const Sphere&>(procedural);
+
+		// Node transforms are rigid + uniform scale for spheres, take the largest axis to stay conservative.
+		const float scale = std::max(glm::length(glm::vec3(world[0])), std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+		const glm::vec3 center = glm::vec3(world * glm::vec4(sphere.Center, 1.0f));
+
+		ProceduralPrimitive primitive = {};
+		primitive.Data = glm::vec4(center, sphere.Radius * scale);
+		primitive.Type = static_cast<uint32_t>(ProceduralType::Sphere);
+		return primitive;
+	}
+
+	const std::array<ProceduralRegistry::Entry, static_cast<size_t>(ProceduralType::Count)> Entries =
+	{{
+		{ "sphere", PackSphere },
+	}};
+}
+
+const ProceduralRegistry::Entry& ProceduralRegistry::Get(const ProceduralType type)
+{
+	const auto index = static_cast<size_t>(type);
+	if (index >= Entries.size())
+	{
+		Throw(std::runtime_error("unknown procedural type " + std::to_string(index)));
+	}
+
+	return Entries[index];
+}
+
+}
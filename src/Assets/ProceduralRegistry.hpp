@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Procedural.hpp"
+
+namespace Assets
+{
+	// Per type handling of procedural shapes, looked up by Procedural::Type().
+	class ProceduralRegistry final
+	{
+	public:
+
+		struct Entry
+		{
+			const char* Name;
+
+			// Bakes the shape with its node transform into the record read by the shaders.
+			ProceduralPrimitive (*Pack)(const Procedural& procedural, const glm::mat4& world);
+		};
+
+		static const Entry& Get(ProceduralType type);
+	};
+
+}
@@ -1,6 +1,7 @@
 #include "Scene.hpp"
+#include "AliasTable.hpp"
 #include "Model.hpp"
-#include "Sphere.hpp"
+#include "ProceduralRegistry.hpp"
 #include "Texture.hpp"
 #include "TextureImage.hpp"
 #include "UniformBuffer.hpp"
@@ -8,27 +9,310 @@
 #include "Vulkan/ImageView.hpp"
 #include "Vulkan/Sampler.hpp"
 #include "Utilities/Exception.hpp"
+#include "Utilities/ThreadPool.hpp"
+#include "Utilities/Tracer.hpp"
 #include "Vulkan/SingleTimeCommands.hpp"
+#include "Vulkan/UploadManager.hpp"
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <future>
+#include <iostream>
+#include <limits>
 
 
 namespace Assets {
 
+namespace
+{
+	// Octahedral normal encoding, the inverse of OctDecode() in CompactVertex.glsl.
+	glm::vec2 OctEncode(const glm::vec3& normal)
+	{
+		const float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+		if (sum == 0.0f)
+		{
+			return glm::vec2(0.0f);
+		}
+
+		const glm::vec3 n = normal / sum;
+		if (n.z >= 0.0f)
+		{
+			return glm::vec2(n.x, n.y);
+		}
+
+		return glm::vec2(
+			(1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+			(1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+	}
+
+	// Runs once at load time over the concatenated scene vertices.
+	std::vector<CompactVertex> PackVertices(const std::vector<Vertex>& vertices)
+	{
+		std::vector<CompactVertex> packed(vertices.size());
+
+		for (size_t i = 0; i != vertices.size(); ++i)
+		{
+			const Vertex& v = vertices[i];
+			CompactVertex& c = packed[i];
+
+			c.Position = v.Position;
+			c.Normal = glm::packSnorm2x16(OctEncode(v.Normal));
+			c.TexCoord = glm::packHalf2x16(v.TexCoord);
+			c.MaterialIndex = v.MaterialIndex;
+		}
+
+		return packed;
+	}
+
+	// Rec. 709 luminance weights.
+	const glm::vec3 Luminance(0.2126f, 0.7152f, 0.0722f);
+
+	// The sky alias table is built over cells of texels rather than the texels themselves, at most this many.
+	constexpr uint32_t SkyCellsX = 512;
+	constexpr uint32_t SkyCellsY = 256;
+
+	// Emissive triangles are split in batches of this many for the extraction.
+	constexpr size_t EmissiveTriangleBatch = 1 << 16;
+
+	// World space triangle lights for the emissive triangles [first, last) of a node.
+	std::vector<LightObject> CollectEmissiveTriangles(const Node& node, const Model& model, const std::vector<Material>& materials,
+		const std::vector<bool>& covered, const size_t first, const size_t last)
+	{
+		TRACE_ZONE("Emissive Triangles");
+		const glm::mat4& world = node.WorldTransform();
+		const auto& vertices = model.Vertices();
+		const auto& indices = model.Indices();
+		std::vector<LightObject> lights;
+
+		for (size_t t = first; t != last; ++t)
+		{
+			const Vertex& v0 = vertices[indices[t * 3 + 0]];
+			const Vertex& v1 = vertices[indices[t * 3 + 1]];
+			const Vertex& v2 = vertices[indices[t * 3 + 2]];
+
+			const auto materialIndex = static_cast<uint32_t>(v0.MaterialIndex + node.GetMaterialOffset());
+			if (materialIndex >= materials.size() || covered[materialIndex] ||
+				materials[materialIndex].MaterialModel != Material::Enum::DiffuseLight)
+			{
+				continue;
+			}
+
+			const glm::vec3 p0 = glm::vec3(world * glm::vec4(v0.Position, 1.0f));
+			const glm::vec3 p1 = glm::vec3(world * glm::vec4(v1.Position, 1.0f));
+			const glm::vec3 p2 = glm::vec3(world * glm::vec4(v2.Position, 1.0f));
+			const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+			const float length = glm::length(cross);
+			if (!(length > 0.0f))
+			{
+				continue;
+			}
+
+			// Only the front face emits, orient the light like the shading normals.
+			const glm::vec3 shading = glm::mat3(world) * (v0.Normal + v1.Normal + v2.Normal);
+			const glm::vec3 normal = glm::dot(cross, shading) < 0.0f ? -cross / length : cross / length;
+
+			LightObject light {};
+			light.p0 = glm::vec4(p0, 1.0f);
+			light.p1 = glm::vec4(p1, 1.0f);
+			light.p3 = glm::vec4(p2, 1.0f);
+			light.normal_area = glm::vec4(normal, length / 2.0f);
+			light.material_index = materialIndex;
+			light.triangle = 1;
+			lights.push_back(light);
+		}
+
+		return lights;
+	}
+
+	// Appends a triangle light for every emissive triangle whose material has no light yet. The quads from the
+	// loaders (Cornell box, light quads, glTF area lights) already stand for their material and are kept as is.
+	// Runs on the shared thread pool, the lights keep the node and triangle order.
+	size_t AppendEmissiveTriangles(const std::vector<Node>& nodes, const std::vector<Model>& models,
+		const std::vector<Material>& materials, std::vector<LightObject>& lights)
+	{
+		std::vector<bool> covered(materials.size());
+		for (const auto& light : lights)
+		{
+			if (light.material_index < materials.size())
+			{
+				covered[light.material_index] = true;
+			}
+		}
+
+		bool emissive = false;
+		for (size_t i = 0; i != materials.size(); ++i)
+		{
+			emissive |= materials[i].MaterialModel == Material::Enum::DiffuseLight && !covered[i];
+		}
+
+		if (!emissive)
+		{
+			return 0;
+		}
+
+		std::vector<std::future<std::vector<LightObject>>> batches;
+		for (const auto& node : nodes)
+		{
+			const auto& model = models[node.GetModel()];
+			if (model.Procedural() != nullptr)
+			{
+				continue;
+			}
+
+			const size_t triangleCount = model.Indices().size() / 3;
+			for (size_t first = 0; first < triangleCount; first += EmissiveTriangleBatch)
+			{
+				const size_t last = std::min(first + EmissiveTriangleBatch, triangleCount);
+				batches.push_back(Utilities::ThreadPool::Shared().Submit([&node, &model, &materials, &covered, first, last]()
+				{
+					return CollectEmissiveTriangles(node, model, materials, covered, first, last);
+				}));
+			}
+		}
+
+		const size_t lightCount = lights.size();
+		for (auto& batch : batches)
+		{
+			const auto found = batch.get();
+			lights.insert(lights.end(), found.begin(), found.end());
+		}
+
+		return lights.size() - lightCount;
+	}
+
+	// Nodes with at least one triangle of a DiffuseLight material, their lights are baked in world space.
+	std::vector<bool> FindEmissiveNodes(const std::vector<Node>& nodes, const std::vector<Model>& models,
+		const std::vector<Material>& materials)
+	{
+		std::vector<std::vector<int32_t>> modelMaterials(models.size());
+		for (size_t m = 0; m != models.size(); ++m)
+		{
+			auto& used = modelMaterials[m];
+			for (const auto& vertex : models[m].Vertices())
+			{
+				used.push_back(vertex.MaterialIndex);
+			}
+
+			std::sort(used.begin(), used.end());
+			used.erase(std::unique(used.begin(), used.end()), used.end());
+		}
+
+		std::vector<bool> emissive(nodes.size());
+		for (size_t n = 0; n != nodes.size(); ++n)
+		{
+			for (const int32_t material : modelMaterials[nodes[n].GetModel()])
+			{
+				const auto materialIndex = static_cast<uint32_t>(material + nodes[n].GetMaterialOffset());
+				if (materialIndex < materials.size() && materials[materialIndex].MaterialModel == Material::Enum::DiffuseLight)
+				{
+					emissive[n] = true;
+					break;
+				}
+			}
+		}
+
+		return emissive;
+	}
+
+	// Power of a light is its area times the luminance of its emitting material. Lights without a known
+	// material are weighted by area alone.
+	std::vector<AliasEntry> BuildLightAliasTable(const std::vector<LightObject>& lights, const std::vector<Material>& materials)
+	{
+		std::vector<float> weights(lights.size());
+
+		for (size_t i = 0; i != lights.size(); ++i)
+		{
+			const auto& light = lights[i];
+			const glm::vec3 radiance = light.material_index < materials.size()
+				? glm::vec3(materials[light.material_index].Diffuse)
+				: glm::vec3(1.0f);
+
+			weights[i] = glm::dot(radiance, Luminance) * light.normal_area.w;
+		}
+
+		return AliasTable::Build(weights);
+	}
+
+	// Alias table over the cells of the equirectangular sky. A cell is weighted by its average luminance, clamped
+	// the same way as in RayTracing.rmiss, times sin(theta) as the solid angle of a row shrinks towards the poles.
+	// Leaves cells at zero when the texture is not an HDR sky.
+	std::vector<AliasEntry> BuildSkyAliasTable(const Texture& sky, glm::uvec2& cells)
+	{
+		cells = glm::uvec2(0);
+
+		if (!sky.Hdr() || sky.Pixels() == nullptr || sky.Width() <= 0 || sky.Height() <= 0)
+		{
+			return {};
+		}
+
+		const auto width = static_cast<uint32_t>(sky.Width());
+		const auto height = static_cast<uint32_t>(sky.Height());
+		// HDR textures are decoded as 4 float channels.
+		const auto* const pixels = reinterpret_cast<const float*>(sky.Pixels());
+
+		cells = glm::uvec2(std::min(width, SkyCellsX), std::min(height, SkyCellsY));
+		std::vector<float> weights(static_cast<size_t>(cells.x) * cells.y);
+
+		for (uint32_t cy = 0; cy != cells.y; ++cy)
+		{
+			const uint32_t y0 = cy * height / cells.y;
+			const uint32_t y1 = (cy + 1) * height / cells.y;
+			const float sinTheta = std::sin(glm::pi<float>() * (cy + 0.5f) / cells.y);
+
+			for (uint32_t cx = 0; cx != cells.x; ++cx)
+			{
+				const uint32_t x0 = cx * width / cells.x;
+				const uint32_t x1 = (cx + 1) * width / cells.x;
+
+				double sum = 0;
+				for (uint32_t y = y0; y != y1; ++y)
+				{
+					for (uint32_t x = x0; x != x1; ++x)
+					{
+						const float* const texel = pixels + (static_cast<size_t>(y) * width + x) * 4;
+						sum += glm::dot(glm::min(glm::vec3(texel[0], texel[1], texel[2]), glm::vec3(10.0f)), Luminance);
+					}
+				}
+
+				weights[static_cast<size_t>(cy) * cells.x + cx] = static_cast<float>(sum / ((x1 - x0) * (y1 - y0))) * sinTheta;
+			}
+		}
+
+		return AliasTable::Build(weights);
+	}
+}
+
 Scene::Scene(Vulkan::CommandPool& commandPool,
 	std::vector<Node>&& nodes,
 	std::vector<Model>&& models,
 	std::vector<Texture>&& textures,
 	std::vector<Material>&& materials,
 	std::vector<LightObject>&& lights,
-	bool supportRayTracing) :
+	bool supportRayTracing,
+	bool compactVertices) :
 	models_(std::move(models)),
 	textures_(std::move(textures)),
-	nodes_(std::move(nodes))
+	nodes_(std::move(nodes)),
+	compactVertices_(compactVertices ? VK_TRUE : VK_FALSE)
 {
+	TRACE_ZONE("Scene Upload");
+	vertexSpecializationEntry_.constantID = 0;
+	vertexSpecializationEntry_.offset = 0;
+	vertexSpecializationEntry_.size = sizeof(VkBool32);
+
+	vertexSpecialization_.mapEntryCount = 1;
+	vertexSpecialization_.pMapEntries = &vertexSpecializationEntry_;
+	vertexSpecialization_.dataSize = sizeof(VkBool32);
+	vertexSpecialization_.pData = &compactVertices_;
+
 	// Concatenate all the models
 	std::vector<Vertex> vertices;
 	std::vector<uint32_t> indices;
 	
-	std::vector<glm::vec4> procedurals;
+	std::vector<ProceduralPrimitive> procedurals;
 	std::vector<VkAabbPositionsKHR> aabbs;
 	std::vector<glm::uvec2> offsets;
 	
@@ -49,55 +333,117 @@ Scene::Scene(Vulkan::CommandPool& commandPool,
 		// {
 		// 	vertices[i].MaterialIndex += materialOffset;
 		// }
+	}
 
-		// Add optional procedurals.
-		const auto* const sphere = dynamic_cast<const Sphere*>(model.Procedural());
-		if (sphere != nullptr)
+	// One world space primitive per procedural node, the ray tracer packs them into a few multi-AABB BLASes.
+	for (const auto& node : nodes_)
+	{
+		const auto& model = models_[node.GetModel()];
+		const auto* const procedural = model.Procedural();
+		if (procedural == nullptr)
 		{
-			const auto aabb = sphere->BoundingBox();
-			aabbs.push_back({aabb.first.x, aabb.first.y, aabb.first.z, aabb.second.x, aabb.second.y, aabb.second.z});
-			procedurals.emplace_back(sphere->Center, sphere->Radius);
+			continue;
 		}
-		else
+
+		const glm::mat4& world = node.WorldTransform();
+		ProceduralPrimitive primitive = ProceduralRegistry::Get(procedural->Type()).Pack(*procedural, world);
+		primitive.MaterialIndex = (model.Vertices().empty() ? 0 : model.Vertices()[0].MaterialIndex) + node.GetMaterialOffset();
+		procedurals.push_back(primitive);
+
+		const auto bounds = procedural->BoundingBox();
+		glm::vec3 aabbMin(std::numeric_limits<float>::max());
+		glm::vec3 aabbMax(-std::numeric_limits<float>::max());
+		for (int corner = 0; corner != 8; ++corner)
 		{
-			aabbs.emplace_back();
-			procedurals.emplace_back();
+			const glm::vec3 local(
+				corner & 1 ? bounds.second.x : bounds.first.x,
+				corner & 2 ? bounds.second.y : bounds.first.y,
+				corner & 4 ? bounds.second.z : bounds.first.z);
+			const glm::vec3 p = glm::vec3(world * glm::vec4(local, 1.0f));
+			aabbMin = glm::min(aabbMin, p);
+			aabbMax = glm::max(aabbMax, p);
 		}
+
+		aabbs.push_back({aabbMin.x, aabbMin.y, aabbMin.z, aabbMax.x, aabbMax.y, aabbMax.z});
 	}
 
 	// node should sort by models, for instancing rendering
 	std::vector<NodeProxy> nodeProxys;
+	nodeProxySlots_.resize(nodes_.size());
+	nodeDirty_.resize(nodes_.size());
 	for (int i = 0; i < models_.size(); i++)
 	{	
 		uint32_t modelCount = 0;
-		for (const auto& node : nodes_)
+		for (size_t n = 0; n != nodes_.size(); ++n)
 		{
+			const auto& node = nodes_[n];
 			if(node.GetModel() == i)
 			{
 				modelCount++;
-				nodeProxys.push_back(NodeProxy{ node.WorldTransform() });
+				nodeProxySlots_[n] = static_cast<uint32_t>(nodeProxys.size());
+				nodeProxys.push_back(NodeProxy{ node.WorldTransform(), static_cast<uint32_t>(i), node.GetMaterialOffset() });
 				//nodeProxys.push_back(NodeProxy{ glm::mat4(1) });
 			}
 		}
 		model_instance_count_.push_back(modelCount);
 	}
 
+	// All the scene buffers and textures go through one batched upload.
+	const auto uploadTimer = std::chrono::high_resolution_clock::now();
+	Vulkan::UploadManager uploads(commandPool);
+
 	int flags =supportRayTracing ? (VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) : VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 	int rtxFlags = supportRayTracing ? VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR : 0;
 	
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Vertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | rtxFlags | flags, vertices, vertexBuffer_, vertexBufferMemory_);
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Indices", VK_BUFFER_USAGE_INDEX_BUFFER_BIT | rtxFlags | flags, indices, indexBuffer_, indexBufferMemory_);
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Materials", flags, materials, materialBuffer_, materialBufferMemory_);
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Offsets", flags, offsets, offsetBuffer_, offsetBufferMemory_);
+	if (compactVertices_)
+	{
+		const auto timer = std::chrono::high_resolution_clock::now();
+		const auto packed = PackVertices(vertices);
+		const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(
+			std::chrono::high_resolution_clock::now() - timer).count();
+
+		std::cout << "- packed " << packed.size() << " compact vertices in " << elapsed << "s" << std::endl;
+		Vulkan::BufferUtil::CreateDeviceBuffer(uploads, "Vertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | rtxFlags | flags, packed, vertexBuffer_, vertexBufferMemory_);
+	}
+	else
+	{
+		Vulkan::BufferUtil::CreateDeviceBuffer(uploads, "Vertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | rtxFlags | flags, vertices, vertexBuffer_, vertexBufferMemory_);
+	}
+
+	Vulkan::BufferUtil::CreateDeviceBuffer(uploads, "Indices", VK_BUFFER_USAGE_INDEX_BUFFER_BIT | rtxFlags | flags, indices, indexBuffer_, indexBufferMemory_);
+	Vulkan::BufferUtil::CreateDeviceBuffer(uploads, "Materials", flags, materials, materialBuffer_, materialBufferMemory_);
+	Vulkan::BufferUtil::CreateDeviceBuffer(uploads, "Offsets", flags, offsets, offsetBuffer_, offsetBufferMemory_);
+
+	Vulkan::BufferUtil::CreateDeviceBuffer(uploads, "AABBs", rtxFlags | flags, aabbs, aabbBuffer_, aabbBufferMemory_);
+	Vulkan::BufferUtil::CreateDeviceBuffer(uploads, "Procedurals", flags, procedurals, proceduralBuffer_, proceduralBufferMemory_);
+
+	const auto emissiveTimer = std::chrono::high_resolution_clock::now();
+	const size_t emissiveCount = AppendEmissiveTriangles(nodes_, models_, materials, lights);
+	if (emissiveCount != 0)
+	{
+		const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(
+			std::chrono::high_resolution_clock::now() - emissiveTimer).count();
+
+		std::cout << "- extracted " << emissiveCount << " emissive triangle lights in " << elapsed << "s" << std::endl;
+	}
 
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "AABBs", rtxFlags | flags, aabbs, aabbBuffer_, aabbBufferMemory_);
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Procedurals", flags, procedurals, proceduralBuffer_, proceduralBufferMemory_);
+	nodeEmissive_ = FindEmissiveNodes(nodes_, models_, materials);
 
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Lights", flags, lights, lightBuffer_, lightBufferMemory_);
+	Vulkan::BufferUtil::CreateDeviceBuffer(uploads, "Lights", flags, lights, lightBuffer_, lightBufferMemory_);
+	Vulkan::BufferUtil::CreateDeviceBuffer(uploads, "LightAlias", flags, BuildLightAliasTable(lights, materials), lightAliasBuffer_, lightAliasBufferMemory_);
 
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Nodes", flags, nodeProxys, nodeMatrixBuffer_, nodeMatrixBufferMemory_);
+	// Texture 0 is the global sky.
+	Vulkan::BufferUtil::CreateDeviceBuffer(uploads, "SkyAlias", flags,
+		textures_.empty() ? std::vector<AliasEntry>() : BuildSkyAliasTable(textures_[0], skyAliasCells_),
+		skyAliasBuffer_, skyAliasBufferMemory_);
+
+	Vulkan::BufferUtil::CreateDeviceBuffer(uploads, "Nodes", flags, nodeProxys, nodeMatrixBuffer_, nodeMatrixBufferMemory_);
+
+	std::cout << "- scene geometry: " << vertices.size() << " vertices, " << indices.size() << " indices ("
+		<< static_cast<float>(vertices.size() * VertexStride() + indices.size() * sizeof(uint32_t)) / (1024 * 1024) << " MB)" << std::endl;
 
 	lightCount_ = lights.size();
+	proceduralCount_ = static_cast<uint32_t>(procedurals.size());
 	
 	// Upload all textures
 	textureImages_.reserve(textures_.size());
@@ -106,10 +452,83 @@ Scene::Scene(Vulkan::CommandPool& commandPool,
 
 	for (size_t i = 0; i != textures_.size(); ++i)
 	{
-	   textureImages_.emplace_back(new TextureImage(commandPool, textures_[i]));
+	   textureImages_.emplace_back(new TextureImage(uploads, textures_[i]));
 	   textureImageViewHandles_[i] = textureImages_[i]->ImageView().Handle();
 	   textureSamplerHandles_[i] = textureImages_[i]->Sampler().Handle();
 	}
+
+	uploads.Wait();
+
+	const auto uploadElapsed = std::chrono::duration<float, std::chrono::seconds::period>(
+		std::chrono::high_resolution_clock::now() - uploadTimer).count();
+
+	std::cout << "- uploaded " << static_cast<float>(uploads.UploadedBytes()) / (1024 * 1024) << " MB in "
+		<< uploads.SubmitCount() << " submits in " << uploadElapsed << "s" << std::endl;
+}
+
+uint32_t Scene::VertexStride() const
+{
+	return compactVertices_ ? sizeof(CompactVertex) : sizeof(Vertex);
+}
+
+bool Scene::CanMoveNode(const uint32_t nodeIndex) const
+{
+	const auto& node = nodes_[nodeIndex];
+	return !node.IsProcedural() && models_[node.GetModel()].Procedural() == nullptr && !nodeEmissive_[nodeIndex];
+}
+
+void Scene::SetNodeTransform(const uint32_t nodeIndex, const glm::mat4& transform)
+{
+	if (nodeIndex >= nodes_.size())
+	{
+		Throw(std::out_of_range("node index is too large"));
+	}
+
+	if (!CanMoveNode(nodeIndex))
+	{
+		Throw(std::runtime_error("procedural and emissive nodes cannot be moved"));
+	}
+
+	nodes_[nodeIndex].Transform(transform);
+
+	if (!nodeDirty_[nodeIndex])
+	{
+		nodeDirty_[nodeIndex] = true;
+		dirtyNodes_.push_back(nodeIndex);
+	}
+}
+
+void Scene::RecordNodeUpdates(VkCommandBuffer commandBuffer) const
+{
+	if (dirtyNodes_.empty())
+	{
+		return;
+	}
+
+	// Only the matrices change, each one is a small inline update.
+	for (const uint32_t nodeIndex : dirtyNodes_)
+	{
+		const VkDeviceSize offset = nodeProxySlots_[nodeIndex] * sizeof(NodeProxy) + offsetof(NodeProxy, transform);
+		vkCmdUpdateBuffer(commandBuffer, nodeMatrixBuffer_->Handle(), offset, sizeof(glm::mat4), &nodes_[nodeIndex].WorldTransform());
+	}
+
+	VkMemoryBarrier memoryBarrier = {};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+		1, &memoryBarrier, 0, nullptr, 0, nullptr);
+}
+
+void Scene::ClearDirtyNodes()
+{
+	for (const uint32_t nodeIndex : dirtyNodes_)
+	{
+		nodeDirty_[nodeIndex] = false;
+	}
+
+	dirtyNodes_.clear();
 }
 
 Scene::~Scene()
@@ -129,6 +548,10 @@ Scene::~Scene()
 	indexBufferMemory_.reset(); // release memory after bound buffer has been destroyed
 	vertexBuffer_.reset();
 	vertexBufferMemory_.reset(); // release memory after bound buffer has been destroyed
+	skyAliasBuffer_.reset();
+	skyAliasBufferMemory_.reset();
+	lightAliasBuffer_.reset();
+	lightAliasBufferMemory_.reset();
 	lightBuffer_.reset();
 	lightBufferMemory_.reset();
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Vulkan/Vulkan.hpp"
+#include "Utilities/Glm.hpp"
 #include <memory>
 #include <vector>
 
@@ -36,13 +37,20 @@ namespace Assets
 			std::vector<Texture>&& textures,
 			std::vector<Material>&& materials,
 			std::vector<LightObject>&& lights,
-			bool supportRayTracing);
+			bool supportRayTracing,
+			bool compactVertices);
 		~Scene();
 
 		const std::vector<Node>& Nodes() const { return nodes_; }
 		const std::vector<Model>& Models() const { return models_; }
 		bool HasProcedurals() const { return static_cast<bool>(proceduralBuffer_); }
 
+		// Layout of the vertex buffer, either Vertex or CompactVertex.
+		bool CompactVertices() const { return compactVertices_; }
+		uint32_t VertexStride() const;
+		// Sets the CompactVertices specialization constant (constant_id 0) of the shaders reading vertices.
+		const VkSpecializationInfo* VertexSpecialization() const { return &vertexSpecialization_; }
+
 		const Vulkan::Buffer& VertexBuffer() const { return *vertexBuffer_; }
 		const Vulkan::Buffer& IndexBuffer() const { return *indexBuffer_; }
 		const Vulkan::Buffer& MaterialBuffer() const { return *materialBuffer_; }
@@ -50,19 +58,43 @@ namespace Assets
 		const Vulkan::Buffer& AabbBuffer() const { return *aabbBuffer_; }
 		const Vulkan::Buffer& ProceduralBuffer() const { return *proceduralBuffer_; }
 		const Vulkan::Buffer& LightBuffer() const { return *lightBuffer_; }
+		// Alias table over the lights, weighted by their power.
+		const Vulkan::Buffer& LightAliasBuffer() const { return *lightAliasBuffer_; }
+		// Alias table over the cells of the HDR sky (texture 0), weighted by luminance and solid angle.
+		const Vulkan::Buffer& SkyAliasBuffer() const { return *skyAliasBuffer_; }
+		// Cells of the sky alias table along u and v, zero when the sky is not an HDR texture.
+		glm::uvec2 SkyAliasCells() const { return skyAliasCells_; }
 		const Vulkan::Buffer& NodeMatrixBuffer() const { return *nodeMatrixBuffer_; }
 		const std::vector<VkImageView> TextureImageViews() const { return textureImageViewHandles_; }
 		const std::vector<VkSampler> TextureSamplers() const { return textureSamplerHandles_; }
 		const std::vector<uint32_t>& ModelInstanceCount() const { return model_instance_count_; }
 
 		const uint32_t GetLightCount() const {return lightCount_;}
+		// Number of entries in the AABB / Procedurals buffers, one per procedural node.
+		uint32_t ProceduralCount() const { return proceduralCount_; }
+
+		// Moves a node without reloading the scene. The node is marked dirty until ClearDirtyNodes(),
+		// RecordNodeUpdates() pushes the new transforms to the Nodes buffer.
+		// Procedural nodes are baked into world space AABBs and emissive nodes into world space lights, neither can be moved.
+		bool CanMoveNode(uint32_t nodeIndex) const;
+		void SetNodeTransform(uint32_t nodeIndex, const glm::mat4& transform);
+		const std::vector<uint32_t>& DirtyNodes() const { return dirtyNodes_; }
+		// Slot of the node in the Nodes buffer, nodes are grouped by model there.
+		uint32_t NodeProxySlot(uint32_t nodeIndex) const { return nodeProxySlots_[nodeIndex]; }
+		// Must be recorded outside of a render pass.
+		void RecordNodeUpdates(VkCommandBuffer commandBuffer) const;
+		void ClearDirtyNodes();
 
 	private:
 
 		const std::vector<Model> models_;
 		const std::vector<Texture> textures_;
-		const std::vector<Node> nodes_;
+		std::vector<Node> nodes_;
 		std::vector<uint32_t> model_instance_count_;
+		std::vector<uint32_t> nodeProxySlots_;
+		std::vector<uint32_t> dirtyNodes_;
+		std::vector<bool> nodeDirty_;
+		std::vector<bool> nodeEmissive_;
 
 		std::unique_ptr<Vulkan::Buffer> vertexBuffer_;
 		std::unique_ptr<Vulkan::DeviceMemory> vertexBufferMemory_;
@@ -85,6 +117,13 @@ namespace Assets
 		std::unique_ptr<Vulkan::Buffer> lightBuffer_;
 		std::unique_ptr<Vulkan::DeviceMemory> lightBufferMemory_;
 
+		std::unique_ptr<Vulkan::Buffer> lightAliasBuffer_;
+		std::unique_ptr<Vulkan::DeviceMemory> lightAliasBufferMemory_;
+
+		std::unique_ptr<Vulkan::Buffer> skyAliasBuffer_;
+		std::unique_ptr<Vulkan::DeviceMemory> skyAliasBufferMemory_;
+		glm::uvec2 skyAliasCells_{};
+
 		std::unique_ptr<Vulkan::Buffer> nodeMatrixBuffer_;
 		std::unique_ptr<Vulkan::DeviceMemory> nodeMatrixBufferMemory_;
 		
@@ -94,6 +133,11 @@ namespace Assets
 		std::vector<VkSampler> textureSamplerHandles_;
 
 		uint32_t lightCount_ {};
+		uint32_t proceduralCount_ {};
+
+		VkBool32 compactVertices_ {};
+		VkSpecializationMapEntry vertexSpecializationEntry_ {};
+		VkSpecializationInfo vertexSpecialization_ {};
 	};
 
 }
@@ -0,0 +1,371 @@
+#include "SceneCache.hpp"
+#include "Utilities/AtomicFile.hpp"
+#include "Utilities/Console.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace Assets
+{
+    namespace
+    {
+        // Bump whenever the loaders change what they produce for the same source file.
+        const uint32_t CacheMagic = 0x43534B47; // 'GKSC'
+        const uint32_t CacheVersion = 5;
+
+        struct CacheHeader
+        {
+            uint32_t Magic;
+            uint32_t Version;
+            uint32_t Variant;
+            uint32_t VertexSize;
+            uint32_t MaterialSize;
+            uint32_t LightSize;
+            uint64_t SourceSize;
+            int64_t SourceTime;
+            uint64_t BaseNodes;
+            uint64_t BaseModels;
+            uint64_t BaseTextures;
+            uint64_t BaseMaterials;
+            uint64_t BaseLights;
+            uint32_t HasCamera;
+            uint32_t NodeCount;
+            uint32_t ModelCount;
+            uint32_t TextureCount;
+            uint32_t MaterialCount;
+            uint32_t LightCount;
+            uint32_t DependencyCount;
+        };
+
+        struct NodeRecord
+        {
+            glm::mat4 Transform;
+            int32_t Model;
+            int32_t Procedural;
+        };
+
+        struct ModelRecord
+        {
+            uint32_t VertexCount;
+            uint32_t IndexCount;
+            glm::vec3 AabbMin;
+            glm::vec3 AabbMax;
+        };
+
+        class Reader final
+        {
+        public:
+            Reader(const char* data, size_t size) : cursor_(data), end_(data + size) {}
+
+            bool Read(void* dst, size_t size)
+            {
+                if (static_cast<size_t>(end_ - cursor_) < size)
+                {
+                    return false;
+                }
+
+                std::memcpy(dst, cursor_, size);
+                cursor_ += size;
+                return true;
+            }
+
+            template <class T>
+            bool ReadArray(std::vector<T>& out, size_t count)
+            {
+                out.resize(count);
+                return Read(out.data(), count * sizeof(T));
+            }
+
+        private:
+            const char* cursor_;
+            const char* end_;
+        };
+
+        template <class T>
+        void WriteArray(std::ofstream& out, const T* data, size_t count)
+        {
+            out.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+        }
+
+        // A file the loader read besides the source (.mtl library, external texture), stored as
+        // [size, time, path length, path]. Missing files are recorded too, so they are noticed when they appear.
+        struct DependencyRecord
+        {
+            uint64_t Size;
+            int64_t Time;
+            uint32_t PathLength;
+        };
+
+        bool QuerySource(const std::string& filename, uint64_t& size, int64_t& time)
+        {
+            std::error_code err;
+            size = std::filesystem::file_size(filename, err);
+            if (err)
+            {
+                return false;
+            }
+
+            time = static_cast<int64_t>(std::filesystem::last_write_time(filename, err).time_since_epoch().count());
+            return !err;
+        }
+
+        DependencyRecord QueryDependency(const std::string& filename)
+        {
+            DependencyRecord record{0, 0, static_cast<uint32_t>(filename.size())};
+            if (!QuerySource(filename, record.Size, record.Time))
+            {
+                record.Size = std::numeric_limits<uint64_t>::max();
+                record.Time = 0;
+            }
+
+            return record;
+        }
+    }
+
+    SceneCache::Base SceneCache::Snapshot(const std::vector<Node>& nodes, const std::vector<Model>& models,
+                                          const std::vector<Texture>& textures, const std::vector<Material>& materials,
+                                          const std::vector<LightObject>& lights)
+    {
+        return Base{nodes.size(), models.size(), textures.size(), materials.size(), lights.size()};
+    }
+
+    std::string SceneCache::CachePath(const std::string& filename)
+    {
+        return filename + ".gkscene";
+    }
+
+    bool SceneCache::Load(const std::string& filename, uint32_t variant, CameraInitialSate* camera,
+                          std::vector<Node>& nodes, std::vector<Model>& models, std::vector<Texture>& textures,
+                          std::vector<Material>& materials, std::vector<LightObject>& lights)
+    {
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        if (!QuerySource(filename, sourceSize, sourceTime))
+        {
+            return false;
+        }
+
+        std::ifstream in(CachePath(filename), std::ios::binary | std::ios::ate);
+        if (!in)
+        {
+            return false;
+        }
+
+        // Pull the whole file in with a single read, everything below is plain copies out of it.
+        std::vector<char> data(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        if (!in.read(data.data(), data.size()))
+        {
+            return false;
+        }
+
+        Reader reader(data.data(), data.size());
+        CacheHeader header{};
+        if (!reader.Read(&header, sizeof(header)) ||
+            header.Magic != CacheMagic ||
+            header.Version != CacheVersion ||
+            header.Variant != variant ||
+            header.VertexSize != sizeof(Vertex) ||
+            header.MaterialSize != sizeof(Material) ||
+            header.LightSize != sizeof(LightObject) ||
+            header.SourceSize != sourceSize ||
+            header.SourceTime != sourceTime ||
+            header.BaseNodes != nodes.size() ||
+            header.BaseModels != models.size() ||
+            header.BaseTextures != textures.size() ||
+            header.BaseMaterials != materials.size() ||
+            header.BaseLights != lights.size() ||
+            (header.HasCamera != 0) != (camera != nullptr))
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i != header.DependencyCount; ++i)
+        {
+            DependencyRecord record{};
+            std::string path;
+            if (!reader.Read(&record, sizeof(record)))
+            {
+                return false;
+            }
+
+            path.resize(record.PathLength);
+            if (!reader.Read(path.data(), record.PathLength))
+            {
+                return false;
+            }
+
+            const DependencyRecord current = QueryDependency(path);
+            if (current.Size != record.Size || current.Time != record.Time)
+            {
+                return false;
+            }
+        }
+
+        CameraInitialSate cachedCamera{};
+        std::vector<NodeRecord> nodeRecords;
+        std::vector<ModelRecord> modelRecords;
+        std::vector<Material> cachedMaterials;
+        std::vector<LightObject> cachedLights;
+        std::vector<TextureSource> textureSources(header.TextureCount);
+
+        if ((camera != nullptr && !reader.Read(&cachedCamera, sizeof(cachedCamera))) ||
+            !reader.ReadArray(nodeRecords, header.NodeCount) ||
+            !reader.ReadArray(modelRecords, header.ModelCount) ||
+            !reader.ReadArray(cachedMaterials, header.MaterialCount) ||
+            !reader.ReadArray(cachedLights, header.LightCount))
+        {
+            return false;
+        }
+
+        for (auto& source : textureSources)
+        {
+            uint32_t nameLength, encodedLength;
+            if (!reader.Read(&nameLength, sizeof(nameLength)) || !reader.Read(&encodedLength, sizeof(encodedLength)))
+            {
+                return false;
+            }
+
+            source.Loadname.resize(nameLength);
+            if (!reader.Read(source.Loadname.data(), nameLength) || !reader.ReadArray(source.Encoded, encodedLength))
+            {
+                return false;
+            }
+        }
+
+        std::vector<Model> cachedModels;
+        cachedModels.reserve(modelRecords.size());
+        for (const auto& record : modelRecords)
+        {
+            std::vector<Vertex> vertices;
+            std::vector<uint32_t> indices;
+            if (!reader.ReadArray(vertices, record.VertexCount) || !reader.ReadArray(indices, record.IndexCount))
+            {
+                return false;
+            }
+
+            cachedModels.push_back(Model(std::move(vertices), std::move(indices), record.AabbMin, record.AabbMax));
+        }
+
+        // The file is fully validated, commit it to the scene.
+        for (const auto& source : textureSources)
+        {
+            textures.push_back(source.Encoded.empty()
+                                   ? Texture::LoadTexture(source.Loadname, Vulkan::SamplerConfig())
+                                   : Texture::LoadTexture(source.Loadname, source.Encoded.data(), source.Encoded.size(),
+                                                          Vulkan::SamplerConfig()));
+        }
+
+        for (const auto& record : nodeRecords)
+        {
+            nodes.push_back(Node::CreateNode(record.Transform, record.Model, record.Procedural != 0));
+        }
+
+        for (auto& model : cachedModels)
+        {
+            models.push_back(std::move(model));
+        }
+
+        materials.insert(materials.end(), cachedMaterials.begin(), cachedMaterials.end());
+        lights.insert(lights.end(), cachedLights.begin(), cachedLights.end());
+
+        if (camera != nullptr)
+        {
+            *camera = cachedCamera;
+        }
+
+        return true;
+    }
+
+    void SceneCache::Save(const std::string& filename, uint32_t variant, const std::vector<std::string>& dependencies,
+                          const Base& base, const CameraInitialSate* camera,
+                          const std::vector<Node>& nodes, const std::vector<Model>& models,
+                          const std::vector<TextureSource>& textureSources, const std::vector<Material>& materials,
+                          const std::vector<LightObject>& lights)
+    {
+        CacheHeader header{};
+        header.Magic = CacheMagic;
+        header.Version = CacheVersion;
+        header.Variant = variant;
+        header.VertexSize = sizeof(Vertex);
+        header.MaterialSize = sizeof(Material);
+        header.LightSize = sizeof(LightObject);
+        if (!QuerySource(filename, header.SourceSize, header.SourceTime))
+        {
+            return;
+        }
+
+        header.DependencyCount = static_cast<uint32_t>(dependencies.size());
+        header.BaseNodes = base.Nodes;
+        header.BaseModels = base.Models;
+        header.BaseTextures = base.Textures;
+        header.BaseMaterials = base.Materials;
+        header.BaseLights = base.Lights;
+        header.HasCamera = camera != nullptr ? 1 : 0;
+        header.NodeCount = static_cast<uint32_t>(nodes.size() - base.Nodes);
+        header.ModelCount = static_cast<uint32_t>(models.size() - base.Models);
+        header.TextureCount = static_cast<uint32_t>(textureSources.size());
+        header.MaterialCount = static_cast<uint32_t>(materials.size() - base.Materials);
+        header.LightCount = static_cast<uint32_t>(lights.size() - base.Lights);
+
+        const std::string cachePath = CachePath(filename);
+        const bool written = Utilities::AtomicFile::Write(cachePath, std::ios::binary, [&](std::ofstream& out)
+        {
+            WriteArray(out, &header, 1);
+            for (const auto& dependency : dependencies)
+            {
+                const DependencyRecord record = QueryDependency(dependency);
+                WriteArray(out, &record, 1);
+                WriteArray(out, dependency.data(), dependency.size());
+            }
+
+            if (camera != nullptr)
+            {
+                WriteArray(out, camera, 1);
+            }
+
+            for (size_t i = base.Nodes; i < nodes.size(); ++i)
+            {
+                const NodeRecord record{nodes[i].WorldTransform(), nodes[i].GetModel(), nodes[i].IsProcedural() ? 1 : 0};
+                WriteArray(out, &record, 1);
+            }
+
+            for (size_t i = base.Models; i < models.size(); ++i)
+            {
+                const ModelRecord record{models[i].NumberOfVertices(), models[i].NumberOfIndices(),
+                                         models[i].GetLocalAABBMin(), models[i].GetLocalAABBMax()};
+                WriteArray(out, &record, 1);
+            }
+
+            WriteArray(out, materials.data() + base.Materials, header.MaterialCount);
+            WriteArray(out, lights.data() + base.Lights, header.LightCount);
+
+            for (const auto& source : textureSources)
+            {
+                const uint32_t nameLength = static_cast<uint32_t>(source.Loadname.size());
+                const uint32_t encodedLength = static_cast<uint32_t>(source.Encoded.size());
+                WriteArray(out, &nameLength, 1);
+                WriteArray(out, &encodedLength, 1);
+                WriteArray(out, source.Loadname.data(), nameLength);
+                WriteArray(out, source.Encoded.data(), encodedLength);
+            }
+
+            for (size_t i = base.Models; i < models.size(); ++i)
+            {
+                WriteArray(out, models[i].Vertices().data(), models[i].Vertices().size());
+                WriteArray(out, models[i].Indices().data(), models[i].Indices().size());
+            }
+        });
+
+        if (!written)
+        {
+            Utilities::Console::Write(Utilities::Severity::Warning, [&cachePath]()
+            {
+                std::cout << "WARNING: failed to write scene cache '" << cachePath << "'" << std::endl;
+            });
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Model.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Assets
+{
+    // Binary snapshot of everything a model loader appended to the scene arrays,
+    // stored next to the source file as '<source>.gkscene'. Indices are stored relative
+    // to the array sizes at the time the loader was called, and the cache is rejected
+    // whenever the size / mtime of the source or of any file it depends on (material
+    // libraries, external textures), or the binary layout does not match.
+    class SceneCache final
+    {
+    public:
+        // Array sizes before the loader runs, everything after them is cached.
+        struct Base
+        {
+            size_t Nodes;
+            size_t Models;
+            size_t Textures;
+            size_t Materials;
+            size_t Lights;
+        };
+
+        // Where a cached texture comes from: a file on disk, or an encoded image embedded in the source.
+        struct TextureSource
+        {
+            std::string Loadname;
+            std::vector<unsigned char> Encoded;
+        };
+
+        static Base Snapshot(const std::vector<Node>& nodes, const std::vector<Model>& models,
+                             const std::vector<Texture>& textures, const std::vector<Material>& materials,
+                             const std::vector<LightObject>& lights);
+
+        static std::string CachePath(const std::string& filename);
+
+        // The variant distinguishes different loader outputs of the same source file.
+        static bool Load(const std::string& filename, uint32_t variant, CameraInitialSate* camera,
+                         std::vector<Node>& nodes, std::vector<Model>& models, std::vector<Texture>& textures,
+                         std::vector<Material>& materials, std::vector<LightObject>& lights);
+
+        // The dependencies are the other files the loader read, they invalidate the cache just like the source.
+        static void Save(const std::string& filename, uint32_t variant, const std::vector<std::string>& dependencies,
+                         const Base& base, const CameraInitialSate* camera,
+                         const std::vector<Node>& nodes, const std::vector<Model>& models,
+                         const std::vector<TextureSource>& textureSources, const std::vector<Material>& materials,
+                         const std::vector<LightObject>& lights);
+    };
+}
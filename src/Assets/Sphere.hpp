@@ -11,7 +11,7 @@ namespace Assets
 	public:
 
 		Sphere(const glm::vec3& center, const float radius) :
-			Center(center), Radius(radius)
+			Procedural(ProceduralType::Sphere), Center(center), Radius(radius)
 		{
 		}
 
@@ -1,6 +1,8 @@
 #include "Texture.hpp"
 #include "Utilities/StbImage.hpp"
 #include "Utilities/Exception.hpp"
+#include "Utilities/ThreadPool.hpp"
+#include "Utilities/Tracer.hpp"
 #include <chrono>
 #include <iostream>
 
@@ -8,74 +10,119 @@ namespace Assets {
 
 Texture Texture::LoadTexture(const std::string& filename, const Vulkan::SamplerConfig& samplerConfig)
 {
-	std::cout << "- loading '" << filename << "'... " << std::flush;
-	const auto timer = std::chrono::high_resolution_clock::now();
+	auto pending = Utilities::ThreadPool::Shared().Submit([filename]()
+	{
+		TRACE_ZONE("Decode Texture");
+		const auto timer = std::chrono::high_resolution_clock::now();
 
-	// Load the texture in normal host memory.
-	int width, height, channels;
-	const auto pixels = stbi_load(filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+		// Load the texture in normal host memory.
+		int width, height, channels;
+		const auto pixels = stbi_load(filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
 
-	if (!pixels)
-	{
-		Throw(std::runtime_error("failed to load texture image '" + filename + "'"));
-	}
+		if (!pixels)
+		{
+			Throw(std::runtime_error("failed to load texture image '" + filename + "'"));
+		}
 
-	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
-	std::cout << "(" << width << " x " << height << " x " << channels << ") ";
-	std::cout << elapsed << "s" << std::endl;
+		const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+		return Decoded{ width, height, channels, {pixels, stbi_image_free}, elapsed };
+	});
 
-	return Texture(filename, width, height, channels, 0, pixels);
+	return Texture(filename, 0, std::move(pending));
 }
 
 Texture Texture::LoadTexture(const std::string& texname, const unsigned char* data, size_t bytelength, const Vulkan::SamplerConfig& samplerConfig)
 {
-	const auto timer = std::chrono::high_resolution_clock::now();
+	// The source buffer usually belongs to the model loader, keep our own copy for the worker.
+	auto encoded = std::make_shared<std::vector<unsigned char>>(data, data + bytelength);
 
-	// Load the texture in normal host memory.
-	int width, height, channels;
-	const auto pixels = stbi_load_from_memory(data, static_cast<uint32_t>(bytelength), &width, &height, &channels, STBI_rgb_alpha);
-
-	if (!pixels)
+	auto pending = Utilities::ThreadPool::Shared().Submit([texname, encoded]()
 	{
-		Throw(std::runtime_error("failed to load texture image "));
-	}
+		TRACE_ZONE("Decode Texture");
+		const auto timer = std::chrono::high_resolution_clock::now();
 
-	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
-	std::cout << texname << "(" << width << " x " << height << " x " << channels << ") ";
-	std::cout << elapsed << "s" << std::endl;
+		// Load the texture in normal host memory.
+		int width, height, channels;
+		const auto pixels = stbi_load_from_memory(encoded->data(), static_cast<uint32_t>(encoded->size()), &width, &height, &channels, STBI_rgb_alpha);
+
+		if (!pixels)
+		{
+			Throw(std::runtime_error("failed to load texture image '" + texname + "'"));
+		}
 
-	return Texture(texname, width, height, channels, 0, pixels);
+		const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+		return Decoded{ width, height, channels, {pixels, stbi_image_free}, elapsed };
+	});
+
+	return Texture(texname, 0, std::move(pending));
 }
 
 Texture Texture::LoadHDRTexture(const std::string& filename, const Vulkan::SamplerConfig& samplerConfig)
 {
-	std::cout << "- loading hdr '" << filename << "'... " << std::flush;
-	const auto timer = std::chrono::high_resolution_clock::now();
+	auto pending = Utilities::ThreadPool::Shared().Submit([filename]()
+	{
+		TRACE_ZONE("Decode Texture");
+		const auto timer = std::chrono::high_resolution_clock::now();
+
+		// Load the texture in normal host memory.
+		int width, height, channels;
+		void* pixels = stbi_loadf(filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+		if (!pixels)
+		{
+			Throw(std::runtime_error("failed to load texture image '" + filename + "'"));
+		}
 
-	// Load the texture in normal host memory.
-	int width, height, channels;
-	void* pixels = stbi_loadf(filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+		const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+		return Decoded{ width, height, channels, {static_cast<unsigned char*>(pixels), stbi_image_free}, elapsed };
+	});
 
-	if (!pixels)
+	return Texture(filename, 1, std::move(pending));
+}
+
+void Texture::JoinAll(std::vector<Texture>& textures)
+{
+	TRACE_ZONE("Join Textures");
+	const auto timer = std::chrono::high_resolution_clock::now();
+
+	float decodeTime = 0;
+	for (auto& texture : textures)
 	{
-		Throw(std::runtime_error("failed to load texture image '" + filename + "'"));
+		decodeTime += texture.Join();
 	}
 
 	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
-	std::cout << "(" << width << " x " << height << " x " << channels << ") ";
-	std::cout << elapsed << "s" << std::endl;
+	std::cout << "- decoded " << textures.size() << " textures on " << Utilities::ThreadPool::Shared().ThreadCount() << " threads, "
+		<< decodeTime << "s decode time, " << elapsed << "s waiting" << std::endl;
+}
+
+float Texture::Join()
+{
+	if (!pending_.valid())
+	{
+		return 0;
+	}
+
+	Decoded decoded = pending_.get();
 
-	return Texture(filename, width, height, channels, 1, static_cast<unsigned char*>((void*)pixels));
+	width_ = decoded.Width;
+	height_ = decoded.Height;
+	channels_ = decoded.Channels;
+	pixels_ = std::move(decoded.Pixels);
+
+	std::cout << "- loading " << (Hdr() ? "hdr '" : "'") << loadname_ << "'... ";
+	std::cout << "(" << width_ << " x " << height_ << " x " << channels_ << ") ";
+	std::cout << decoded.Elapsed << "s" << std::endl;
+
+	return decoded.Elapsed;
 }
 
-Texture::Texture(std::string loadname, int width, int height, int channels, int hdr, unsigned char* const pixels) :
+Texture::Texture(std::string loadname, int hdr, std::future<Decoded>&& pending) :
 	loadname_(loadname),
-	width_(width),
-	height_(height),
-	channels_(channels),
 	hdr_(hdr),
-	pixels_(pixels, stbi_image_free)
+	pixels_(nullptr, stbi_image_free),
+	pending_(std::move(pending))
 {
 }
-	
+
 }
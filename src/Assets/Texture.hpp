@@ -1,8 +1,10 @@
 #pragma once
 
 #include "Vulkan/Sampler.hpp"
+#include <future>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace Assets
 {
@@ -10,10 +12,15 @@ namespace Assets
 	{
 	public:
 
+		// Loading only queues the decode on the shared thread pool, call Join() (or JoinAll())
+		// before touching the pixels.
 		static Texture LoadTexture(const std::string& texname, const unsigned char* data, size_t bytelength, const Vulkan::SamplerConfig& samplerConfig);
 		static Texture LoadTexture(const std::string& filename, const Vulkan::SamplerConfig& samplerConfig);
 		static Texture LoadHDRTexture(const std::string& filename, const Vulkan::SamplerConfig& samplerConfig);
 
+		// Wait for every pending decode and log the per-texture and overall timings.
+		static void JoinAll(std::vector<Texture>& textures);
+
 		Texture& operator = (const Texture&) = delete;
 		Texture& operator = (Texture&&) = delete;
 
@@ -22,6 +29,9 @@ namespace Assets
 		Texture(Texture&&) = default;
 		~Texture() = default;
 
+		// Returns the time the decode took on its worker, or 0 if it was already joined.
+		float Join();
+
 		const unsigned char* Pixels() const { return pixels_.get(); }
 		int Width() const { return width_; }
 		int Height() const { return height_; }
@@ -31,15 +41,25 @@ namespace Assets
 
 	private:
 
-		Texture(std::string loadname, int width, int height, int channels, int hdr, unsigned char* pixels);
+		struct Decoded
+		{
+			int Width;
+			int Height;
+			int Channels;
+			std::unique_ptr<unsigned char, void (*) (void*)> Pixels;
+			float Elapsed;
+		};
+
+		Texture(std::string loadname, int hdr, std::future<Decoded>&& pending);
 
 		Vulkan::SamplerConfig samplerConfig_;
 		std::string loadname_;
-		int width_;
-		int height_;
-		int channels_;
+		int width_{};
+		int height_{};
+		int channels_{};
 		int hdr_;
 		std::unique_ptr<unsigned char, void (*) (void*)> pixels_;
+		std::future<Decoded> pending_;
 	};
 
 }
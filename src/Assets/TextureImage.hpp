@@ -4,11 +4,11 @@
 
 namespace Vulkan
 {
-	class CommandPool;
 	class DeviceMemory;
 	class Image;
 	class ImageView;
 	class Sampler;
+	class UploadManager;
 }
 
 namespace Assets
@@ -24,7 +24,7 @@ namespace Assets
 		TextureImage& operator = (const TextureImage&) = delete;
 		TextureImage& operator = (TextureImage&&) = delete;
 
-		TextureImage(Vulkan::CommandPool& commandPool, const Texture& texture);
+		TextureImage(Vulkan::UploadManager& uploads, const Texture& texture);
 		~TextureImage();
 
 		const Vulkan::ImageView& ImageView() const { return *imageView_; }
@@ -10,6 +10,7 @@ UniformBuffer::UniformBuffer(const Vulkan::Device& device)
 
 	buffer_.reset(new Vulkan::Buffer(device, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT));
 	memory_.reset(new Vulkan::DeviceMemory(buffer_->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+	memory_->SetName("Uniform Buffers");
 }
 
 UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept :
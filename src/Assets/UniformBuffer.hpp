@@ -40,6 +40,10 @@ namespace Assets
 		uint32_t ShowHeatmap; // bool
 		uint32_t UseCheckerBoard; // bool
 		uint32_t TemporalFrames;
+		uint32_t SampleSky; // bool
+		uint32_t SkyCellsX;
+		uint32_t SkyCellsY;
+		uint32_t HeatmapRays; // bool
 	};
 
 	// lightquad can represent by 4 points
@@ -54,6 +58,9 @@ namespace Assets
 	// then the random point is p0 + r1 * (p1 - p0) + r2 * (p3 - p0)
 	// the normal of the quad is (p1 - p0) x (p3 - p0)
 	// the area of the quad is |(p1 - p0) x (p3 - p0)| / 2
+
+	// emissive triangles use the same layout with p0, p1, p3 as corners,
+	// r1 + r2 > 1 is folded back with r1 = 1 - r1, r2 = 1 - r2
 	
 	struct alignas(16) LightObject final
 	{
@@ -61,6 +68,11 @@ namespace Assets
 		glm::vec4 p1;
 		glm::vec4 p3;
 		glm::vec4 normal_area;
+		// The emitting material, its radiance times the area weights the light selection.
+		uint32_t material_index;
+		uint32_t triangle; // bool
+		uint32_t reserved1;
+		uint32_t reserved2;
 	};
 
 	class UniformBuffer
@@ -72,4 +72,67 @@ namespace Assets
 		}
 	};
 
+	// Optional 24 byte encoding of Vertex, selected with --compact-vertices.
+	// Position stays full precision so the BLAS can still build from it directly,
+	// the normal is octahedral encoded as 2x snorm16 and the uv is stored as 2x half.
+	// Shaders decode it with UnpackVertex() / the CompactVertices specialization constant.
+	struct CompactVertex final
+	{
+		glm::vec3 Position;
+		uint32_t Normal;
+		uint32_t TexCoord;
+		int32_t MaterialIndex;
+
+		static VkVertexInputBindingDescription GetBindingDescription()
+		{
+			VkVertexInputBindingDescription bindingDescription = {};
+			bindingDescription.binding = 0;
+			bindingDescription.stride = sizeof(CompactVertex);
+			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+			return bindingDescription;
+		}
+
+		static std::array<VkVertexInputAttributeDescription, 4> GetAttributeDescriptions()
+		{
+			std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions = {};
+
+			attributeDescriptions[0].binding = 0;
+			attributeDescriptions[0].location = 0;
+			attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+			attributeDescriptions[0].offset = offsetof(CompactVertex, Position);
+
+			// Still octahedral encoded, the vertex shader finishes the decode.
+			attributeDescriptions[1].binding = 0;
+			attributeDescriptions[1].location = 1;
+			attributeDescriptions[1].format = VK_FORMAT_R16G16_SNORM;
+			attributeDescriptions[1].offset = offsetof(CompactVertex, Normal);
+
+			attributeDescriptions[2].binding = 0;
+			attributeDescriptions[2].location = 2;
+			attributeDescriptions[2].format = VK_FORMAT_R16G16_SFLOAT;
+			attributeDescriptions[2].offset = offsetof(CompactVertex, TexCoord);
+
+			attributeDescriptions[3].binding = 0;
+			attributeDescriptions[3].location = 3;
+			attributeDescriptions[3].format = VK_FORMAT_R32_SINT;
+			attributeDescriptions[3].offset = offsetof(CompactVertex, MaterialIndex);
+
+			return attributeDescriptions;
+		}
+
+		static std::array<VkVertexInputAttributeDescription, 1> GetFastAttributeDescriptions()
+		{
+			std::array<VkVertexInputAttributeDescription, 1> attributeDescriptions = {};
+
+			attributeDescriptions[0].binding = 0;
+			attributeDescriptions[0].location = 0;
+			attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+			attributeDescriptions[0].offset = offsetof(CompactVertex, Position);
+
+			return attributeDescriptions;
+		}
+	};
+
+	static_assert(sizeof(CompactVertex) == 24, "CompactVertex must match UnpackVertex() in Vertex.glsl");
+
 }
@@ -0,0 +1,102 @@
+#include "VertexWelder.hpp"
+
+#include <cstring>
+
+namespace Assets
+{
+    namespace
+    {
+        const uint32_t EmptySlot = ~0u;
+
+        static_assert(sizeof(Vertex) % sizeof(uint32_t) == 0, "Vertex is hashed as a sequence of 32-bit words");
+    }
+
+    VertexWelder::VertexWelder(std::vector<Vertex>& vertices) :
+        vertices_(vertices)
+    {
+        Rehash(64);
+    }
+
+    void VertexWelder::Reserve(const size_t count)
+    {
+        // Only the slots, the output array grows with the unique vertices and is kept by the model afterwards.
+        // Keep the load factor at or below 1/2.
+        size_t capacity = slots_.size();
+        while (capacity < (vertices_.size() + count) * 2)
+        {
+            capacity *= 2;
+        }
+
+        if (capacity != slots_.size())
+        {
+            Rehash(capacity);
+        }
+    }
+
+    uint32_t VertexWelder::Weld(const Vertex& vertex)
+    {
+        if ((vertices_.size() + 1) * 2 > slots_.size())
+        {
+            Rehash(slots_.size() * 2);
+        }
+
+        for (size_t slot = Hash(vertex) & mask_;; slot = (slot + 1) & mask_)
+        {
+            const uint32_t index = slots_[slot];
+            if (index == EmptySlot)
+            {
+                slots_[slot] = static_cast<uint32_t>(vertices_.size());
+                vertices_.push_back(vertex);
+                return slots_[slot];
+            }
+
+            if (std::memcmp(&vertices_[index], &vertex, sizeof(Vertex)) == 0)
+            {
+                return index;
+            }
+        }
+    }
+
+    uint32_t VertexWelder::Hash(const Vertex& vertex)
+    {
+        uint32_t words[sizeof(Vertex) / sizeof(uint32_t)];
+        std::memcpy(words, &vertex, sizeof(Vertex));
+
+        // murmur3 style mixing of the raw bits
+        uint32_t hash = 0x9e3779b9;
+        for (uint32_t word : words)
+        {
+            word *= 0xcc9e2d51;
+            word = (word << 15) | (word >> 17);
+            word *= 0x1b873593;
+
+            hash ^= word;
+            hash = (hash << 13) | (hash >> 19);
+            hash = hash * 5 + 0xe6546b64;
+        }
+
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6b;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35;
+        hash ^= hash >> 16;
+        return hash;
+    }
+
+    void VertexWelder::Rehash(const size_t capacity)
+    {
+        slots_.assign(capacity, EmptySlot);
+        mask_ = capacity - 1;
+
+        for (uint32_t index = 0; index != vertices_.size(); ++index)
+        {
+            size_t slot = Hash(vertices_[index]) & mask_;
+            while (slots_[slot] != EmptySlot)
+            {
+                slot = (slot + 1) & mask_;
+            }
+
+            slots_[slot] = index;
+        }
+    }
+}
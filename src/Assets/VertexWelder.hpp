@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Vertex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Assets
+{
+    // Merges bit-identical vertices while a mesh is being assembled.
+    // Open-addressing (linear probing) table of indices into the output vertex array,
+    // so there is no per-entry allocation and probes stay within a few cache lines.
+    class VertexWelder final
+    {
+    public:
+        VertexWelder(const VertexWelder&) = delete;
+        VertexWelder(VertexWelder&&) = delete;
+        VertexWelder& operator =(const VertexWelder&) = delete;
+        VertexWelder& operator =(VertexWelder&&) = delete;
+
+        explicit VertexWelder(std::vector<Vertex>& vertices);
+        ~VertexWelder() = default;
+
+        // Size the table for up to `count` incoming vertices, avoids rehashing while welding.
+        // The output vertex array is left alone.
+        void Reserve(size_t count);
+
+        // Returns the index of `vertex` in the output array, appending it if it was not seen before.
+        uint32_t Weld(const Vertex& vertex);
+
+    private:
+        static uint32_t Hash(const Vertex& vertex);
+        void Rehash(size_t capacity);
+
+        std::vector<Vertex>& vertices_;
+        std::vector<uint32_t> slots_;
+        size_t mask_{};
+    };
+}
@@ -0,0 +1,197 @@
+#include "WeldBenchmark.hpp"
+#include "VertexWelder.hpp"
+#include "Utilities/Console.hpp"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#include <tiny_obj_loader.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace Assets
+{
+    namespace
+    {
+        // The std::hash<Vertex> specialization LoadModel had before the welder.
+        struct MapVertexHash final
+        {
+            size_t operator()(const Vertex& vertex) const noexcept
+            {
+                return
+                    Combine(std::hash<glm::vec3>()(vertex.Position),
+                            Combine(std::hash<glm::vec3>()(vertex.Normal),
+                                    Combine(std::hash<glm::vec2>()(vertex.TexCoord),
+                                            std::hash<int>()(vertex.MaterialIndex))));
+            }
+
+            static size_t Combine(const size_t hash0, const size_t hash1)
+            {
+                return hash0 ^ (hash1 + 0x9e3779b9 + (hash0 << 6) + (hash0 >> 2));
+            }
+        };
+
+        // One corner stream per shape, built the same way as LoadModel does.
+        std::vector<std::vector<Vertex>> ReadCorners(const tinyobj::ObjReader& objReader)
+        {
+            const auto& objAttrib = objReader.GetAttrib();
+            std::vector<std::vector<Vertex>> shapes;
+
+            for (const auto& shape : objReader.GetShapes())
+            {
+                const auto& mesh = shape.mesh;
+                auto& corners = shapes.emplace_back();
+                corners.reserve(mesh.indices.size());
+
+                size_t faceId = 0;
+                for (const auto& index : mesh.indices)
+                {
+                    Vertex vertex = {};
+
+                    vertex.Position =
+                    {
+                        objAttrib.vertices[3 * index.vertex_index + 0],
+                        objAttrib.vertices[3 * index.vertex_index + 1],
+                        objAttrib.vertices[3 * index.vertex_index + 2],
+                    };
+
+                    if (!objAttrib.normals.empty())
+                    {
+                        vertex.Normal =
+                        {
+                            objAttrib.normals[3 * index.normal_index + 0],
+                            objAttrib.normals[3 * index.normal_index + 1],
+                            objAttrib.normals[3 * index.normal_index + 2]
+                        };
+                    }
+
+                    if (!objAttrib.texcoords.empty())
+                    {
+                        vertex.TexCoord =
+                        {
+                            objAttrib.texcoords[2 * std::max(0, index.texcoord_index) + 0],
+                            1 - objAttrib.texcoords[2 * std::max(0, index.texcoord_index) + 1]
+                        };
+                    }
+
+                    vertex.MaterialIndex = std::max(0, mesh.material_ids[faceId++ / 3]);
+                    corners.push_back(vertex);
+                }
+            }
+
+            return shapes;
+        }
+
+        // Best of `repeats` runs of weld(corners, vertices, indices) over all the shapes, returns the time in seconds.
+        template <class Weld>
+        double TimeWeld(const std::vector<std::vector<Vertex>>& shapes, const uint32_t repeats, size_t& uniqueCount, Weld weld)
+        {
+            double best = std::numeric_limits<double>::max();
+
+            for (uint32_t r = 0; r != repeats; ++r)
+            {
+                size_t unique = 0;
+                const auto timer = std::chrono::high_resolution_clock::now();
+
+                for (const auto& corners : shapes)
+                {
+                    std::vector<Vertex> vertices;
+                    std::vector<uint32_t> indices;
+                    indices.reserve(corners.size());
+
+                    weld(corners, vertices, indices);
+                    unique += vertices.size();
+                }
+
+                best = std::min(best, std::chrono::duration<double, std::chrono::seconds::period>(
+                    std::chrono::high_resolution_clock::now() - timer).count());
+                uniqueCount = unique;
+            }
+
+            return best;
+        }
+    }
+
+    void WeldBenchmark::Run(const std::string& directory, const uint32_t repeats)
+    {
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::directory_iterator(directory))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".obj")
+            {
+                files.push_back(entry.path());
+            }
+        }
+
+        std::sort(files.begin(), files.end());
+        std::cout << "Welding the face corners of " << files.size() << " OBJ files in '" << directory << "', best of " << repeats << " runs:" << std::endl;
+
+        for (const auto& file : files)
+        {
+            tinyobj::ObjReader objReader;
+            if (!objReader.ParseFromFile(file.string()))
+            {
+                Utilities::Console::Write(Utilities::Severity::Warning, [&file, &objReader]()
+                {
+                    std::cout << "WARNING: failed to load '" << file.string() << "': " << objReader.Error() << std::endl;
+                });
+                continue;
+            }
+
+            const auto shapes = ReadCorners(objReader);
+            size_t cornerCount = 0;
+            for (const auto& corners : shapes)
+            {
+                cornerCount += corners.size();
+            }
+
+            size_t mapUnique = 0;
+            const double mapTime = TimeWeld(shapes, repeats, mapUnique,
+                [](const std::vector<Vertex>& corners, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+            {
+                // Same calls as the old loader, including the count + two lookups per corner.
+                std::unordered_map<Vertex, uint32_t, MapVertexHash> uniqueVertices(corners.size());
+                for (const auto& vertex : corners)
+                {
+                    if (uniqueVertices.count(vertex) == 0)
+                    {
+                        uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+                        vertices.push_back(vertex);
+                    }
+
+                    indices.push_back(uniqueVertices[vertex]);
+                }
+            });
+
+            size_t welderUnique = 0;
+            const double welderTime = TimeWeld(shapes, repeats, welderUnique,
+                [](const std::vector<Vertex>& corners, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+            {
+                VertexWelder welder(vertices);
+                welder.Reserve(corners.size());
+                for (const auto& vertex : corners)
+                {
+                    indices.push_back(welder.Weld(vertex));
+                }
+            });
+
+            std::cout << "- " << file.filename().string() << ": " << cornerCount << " corners, " << welderUnique << " unique, "
+                << std::fixed << std::setprecision(4) << "unordered_map " << mapTime << "s, welder " << welderTime << "s ("
+                << std::setprecision(2) << mapTime / std::max(welderTime, 1e-9) << "x)" << std::defaultfloat << std::endl;
+
+            if (mapUnique != welderUnique)
+            {
+                Utilities::Console::Write(Utilities::Severity::Warning, [mapUnique]()
+                {
+                    std::cout << "WARNING: unordered_map found " << mapUnique << " unique vertices" << std::endl;
+                });
+            }
+        }
+    }
+}
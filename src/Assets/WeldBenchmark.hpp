@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Assets
+{
+    // Times VertexWelder against the std::unordered_map<Vertex> LoadModel used before it, on the face corners of
+    // every OBJ in a directory. Only the welding is timed, parsing the file is not.
+    class WeldBenchmark final
+    {
+    public:
+        // Keeps the best of `repeats` runs of each method and prints one line per file.
+        static void Run(const std::string& directory, uint32_t repeats);
+    };
+}
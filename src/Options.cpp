@@ -14,6 +14,7 @@ Options::Options(const int argc, const char* argv[])
 	benchmark.add_options()
 		("next-scenes", bool_switch(&BenchmarkNextScenes)->default_value(false), "Load the next scene once the sample or time limit is reached.")
 		("max-time", value<uint32_t>(&BenchmarkMaxTime)->default_value(10), "The benchmark time limit per scene (in seconds).")
+		("upload", bool_switch(&BenchmarkUpload)->default_value(false), "Also send the benchmark report to the perf server.")
 		;
 
 	options_description renderer("Renderer options", lineLength);
@@ -23,11 +24,17 @@ Options::Options(const int argc, const char* argv[])
 		("bounces", value<uint32_t>(&Bounces)->default_value(4), "The maximum number of bounces per ray.")
 		("max-samples", value<uint32_t>(&MaxSamples)->default_value(64 * 1024), "The maximum number of accumulated ray samples per pixel.")
 		("temporal", value<uint32_t>(&Temporal)->default_value(256), "The number of temporal frames.")
+		("no-sky-sampling", bool_switch(&NoSkySampling)->default_value(false), "Only reach the HDR sky through BSDF sampled bounces, to compare convergence against sky importance sampling.")
+		("compact-blas", bool_switch(&CompactBlas)->default_value(false), "Compact the bottom level acceleration structures after building them.")
+		("blas-scratch-budget", value<uint32_t>(&BlasScratchBudget)->default_value(64), "The scratch memory budget for one batch of bottom level acceleration structure builds (in MB).")
 		;
 
 	options_description scene("Scene options", lineLength);
 	scene.add_options()
 		("scene", value<uint32_t>(&SceneIndex)->default_value(0), "The scene to start with.")
+		("flatten-vertices", bool_switch(&FlattenVertices)->default_value(false), "Expand every model to one vertex per index instead of keeping indexed geometry.")
+		("compact-vertices", bool_switch(&CompactVertices)->default_value(false), "Upload vertices in the 24 byte compact encoding (octahedral normal, half uv) instead of 36 bytes.")
+		("animate", bool_switch(&Animate)->default_value(false), "Slide one node back and forth through the in-place TLAS refit. In headless mode it is moved once and checked against the primary hits.")
 		;
 
 	options_description vulkan("Vulkan options", lineLength);
@@ -48,6 +55,11 @@ Options::Options(const int argc, const char* argv[])
 		("help", "Display help message.")
 		("benchmark", bool_switch(&Benchmark)->default_value(false), "Run the application in benchmark mode.")
 		("savefile", bool_switch(&SaveFile)->default_value(false), "Save screenshot every benchmark finish.")
+		("headless", bool_switch(&Headless)->default_value(false), "Render offscreen without a window or swap chain, then write the last frame to <scene>.avif.")
+		("frames", value<uint32_t>(&Frames)->default_value(0), "The number of frames to render in headless mode (0 = until max-samples is reached).")
+		("reference", value<std::string>(&Reference)->default_value(""), "In headless mode, print the RMSE of the last frame against this raw image, or write it there if the file does not exist.")
+		("bench-weld", bool_switch(&BenchWeld)->default_value(false), "Time the OBJ vertex welder against the previous std::unordered_map on the bundled models, then exit.")
+		("trace", value<std::string>(&TraceFile)->default_value(""), "Record CPU zones and write them as Chrome trace JSON to this file at exit (F3 writes it on demand).")
 		;
 
 	desc.add(benchmark);
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <exception>
+#include <string>
 #include <vector>
 
 class Options final
@@ -22,10 +23,16 @@ public:
 	// Application options.
 	bool Benchmark{};
 	bool SaveFile{};
+	std::string TraceFile{};
+	bool Headless{};
+	uint32_t Frames{};
+	std::string Reference{};
+	bool BenchWeld{};
 	
 	// Benchmark options.
 	bool BenchmarkNextScenes{};
 	uint32_t BenchmarkMaxTime{};
+	bool BenchmarkUpload{};
 
 	// Renderer options.
 	uint32_t Samples{};
@@ -33,9 +40,15 @@ public:
 	uint32_t MaxSamples{};
 	uint32_t RendererType{};
 	uint32_t Temporal{};
+	bool NoSkySampling{};
+	bool CompactBlas{};
+	uint32_t BlasScratchBudget{};
 	
 	// Scene options.
 	uint32_t SceneIndex{};
+	bool FlattenVertices{};
+	bool CompactVertices{};
+	bool Animate{};
 
 	// Vulkan options
 	std::vector<uint32_t> VisibleDevices{};
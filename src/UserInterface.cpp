@@ -2,6 +2,7 @@
 #include "SceneList.hpp"
 #include "UserSettings.hpp"
 #include "Utilities/Exception.hpp"
+#include "Utilities/Tracer.hpp"
 #include "Vulkan/DescriptorPool.hpp"
 #include "Vulkan/Device.hpp"
 #include "Vulkan/FrameBuffer.hpp"
@@ -113,6 +114,8 @@ UserInterface::~UserInterface()
 
 void UserInterface::Render(VkCommandBuffer commandBuffer, const Vulkan::FrameBuffer& frameBuffer, const Statistics& statistics)
 {
+	TRACE_ZONE("UI");
+
 	ImGui_ImplGlfw_NewFrame();
 	ImGui_ImplVulkan_NewFrame();
 	ImGui::NewFrame();
@@ -191,7 +194,18 @@ void UserInterface::DrawSettings()
 		uint32_t min = 1, max = 128;
 		ImGui::SliderScalar("Samples", ImGuiDataType_U32, &Settings().NumberOfSamples, &min, &max);
 		min = 1, max = 32;
-		ImGui::SliderScalar("Bounces", ImGuiDataType_U32, &Settings().NumberOfBounces, &min, &max);
+		// The bounce limit is compiled into the ray tracing pipeline, rebuild it once per edit rather than per drag step.
+		if (!editingBounces_)
+		{
+			bounces_ = Settings().NumberOfBounces;
+		}
+		ImGui::SliderScalar("Bounces", ImGuiDataType_U32, &bounces_, &min, &max);
+		editingBounces_ = ImGui::IsItemActive();
+		if (ImGui::IsItemDeactivatedAfterEdit())
+		{
+			Settings().NumberOfBounces = bounces_;
+		}
+		ImGui::Checkbox("Sample sky", &Settings().SampleSky);
 		ImGui::NewLine();
 
 		{
@@ -218,6 +232,7 @@ void UserInterface::DrawSettings()
 		ImGui::Text("Profiler");
 		ImGui::Separator();
 		ImGui::Checkbox("Show heatmap", &Settings().ShowHeatmap);
+		ImGui::Checkbox("Rays per pixel", &Settings().HeatmapRays);
 		ImGui::SliderFloat("Scaling", &Settings().HeatmapScale, 0.10f, 10.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
 		ImGui::NewLine();
 
@@ -263,6 +278,16 @@ void UserInterface::DrawOverlay(const Statistics& statistics)
 		ImGui::Text("Primary ray rate: %.2f Gr/s", statistics.RayRate);
 		ImGui::Text("Accumulated samples:  %u", statistics.TotalSamples);
 		ImGui::Text("Campos:  %.2f %.2f %.2f", statistics.CamPosX, statistics.CamPosY, statistics.CamPosZ);
+
+		if (!statistics.GpuTimes.empty())
+		{
+			ImGui::Separator();
+			ImGui::Text("GPU time: %.2f ms", statistics.GpuFrameTime);
+			for (const auto& time : statistics.GpuTimes)
+			{
+				ImGui::Text("  %-12s %6.2f ms", time.first.c_str(), time.second);
+			}
+		}
 	}
 	ImGui::End();
 }
@@ -1,6 +1,9 @@
 #pragma once
 #include "Vulkan/Vulkan.hpp"
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace Vulkan
 {
@@ -23,6 +26,9 @@ struct Statistics final
 	float CamPosX;
 	float CamPosY;
 	float CamPosZ;
+	// Average GPU milliseconds per render pass, in recording order.
+	std::vector<std::pair<std::string, float>> GpuTimes;
+	float GpuFrameTime;
 };
 
 class UserInterface final
@@ -53,4 +59,8 @@ private:
 	std::unique_ptr<Vulkan::DescriptorPool> descriptorPool_;
 	std::unique_ptr<Vulkan::RenderPass> renderPass_;
 	UserSettings& userSettings_;
+
+	// Value of the bounce slider while it is dragged, only applied on release.
+	uint32_t bounces_{};
+	bool editingBounces_{};
 };
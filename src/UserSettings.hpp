@@ -18,6 +18,7 @@ struct UserSettings final
 	uint32_t NumberOfSamples;
 	uint32_t NumberOfBounces;
 	uint32_t MaxNumberOfSamples;
+	bool SampleSky;
 
 	// Camera
 	float FieldOfView;
@@ -28,6 +29,7 @@ struct UserSettings final
 
 	// Profiler
 	bool ShowHeatmap;
+	bool HeatmapRays;
 	float HeatmapScale;
 
 	// UI
@@ -56,10 +58,25 @@ struct UserSettings final
 			IsRayTraced != prev.IsRayTraced ||
 			AccumulateRays != prev.AccumulateRays ||
 			NumberOfBounces != prev.NumberOfBounces ||
+			SampleSky != prev.SampleSky ||
 			FieldOfView != prev.FieldOfView ||
 			Aperture != prev.Aperture ||
 			FocusDistance != prev.FocusDistance ||
 				SkyRotation != prev.SkyRotation ||
 			TemporalFrames != prev.TemporalFrames;
 	}
+
+	// Settings that change how the accumulated samples are shown, without invalidating them.
+	bool RequiresRecompose(const UserSettings& prev) const
+	{
+		return
+			ShowHeatmap != prev.ShowHeatmap ||
+			HeatmapRays != prev.HeatmapRays ||
+			HeatmapScale != prev.HeatmapScale ||
+			DenoiseIteration != prev.DenoiseIteration ||
+			ColorPhi != prev.ColorPhi ||
+			DepthPhi != prev.DepthPhi ||
+			NormalPhi != prev.NormalPhi ||
+			PaperWhiteNit != prev.PaperWhiteNit;
+	}
 };
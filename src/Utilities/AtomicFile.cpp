@@ -0,0 +1,36 @@
+#include "AtomicFile.hpp"
+#include <filesystem>
+#include <system_error>
+
+namespace Utilities {
+
+bool AtomicFile::Write(const std::string& path, const std::ios::openmode mode, const std::function<void(std::ofstream&)>& write)
+{
+	const std::string tempPath = path + ".tmp";
+
+	bool written = false;
+	{
+		std::ofstream out(tempPath, mode | std::ios::out | std::ios::trunc);
+		if (out)
+		{
+			write(out);
+			out.close();
+			written = !out.fail();
+		}
+	}
+
+	std::error_code err;
+	if (written)
+	{
+		std::filesystem::rename(tempPath, path, err);
+		if (!err)
+		{
+			return true;
+		}
+	}
+
+	std::filesystem::remove(tempPath, err);
+	return false;
+}
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <fstream>
+#include <functional>
+#include <string>
+
+namespace Utilities
+{
+	// Writes a file through "<path>.tmp" and renames it into place once complete, so an interrupted run never
+	// leaves a truncated file behind.
+	class AtomicFile final
+	{
+	public:
+
+		// Returns false when the file could not be opened, written or renamed. The previous file is then kept
+		// and the temporary removed.
+		static bool Write(const std::string& path, std::ios::openmode mode, const std::function<void(std::ofstream&)>& write);
+	};
+}
@@ -0,0 +1,59 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+namespace Utilities {
+
+ThreadPool::ThreadPool(const uint32_t threadCount)
+{
+	workers_.reserve(threadCount);
+	for (uint32_t i = 0; i != threadCount; ++i)
+	{
+		workers_.emplace_back([this]() { WorkerLoop(); });
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+
+	condition_.notify_all();
+
+	for (auto& worker : workers_)
+	{
+		worker.join();
+	}
+}
+
+ThreadPool& ThreadPool::Shared()
+{
+	static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+	return pool;
+}
+
+void ThreadPool::WorkerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+
+			if (stopping_ && tasks_.empty())
+			{
+				return;
+			}
+
+			task = std::move(tasks_.front());
+			tasks_.pop();
+		}
+
+		task();
+	}
+}
+
+}
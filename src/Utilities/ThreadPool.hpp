@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Utilities
+{
+	// Fixed size pool of worker threads, tasks run in submission order.
+	// Exceptions thrown by a task are rethrown from the returned future.
+	class ThreadPool final
+	{
+	public:
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool(ThreadPool&&) = delete;
+		ThreadPool& operator = (const ThreadPool&) = delete;
+		ThreadPool& operator = (ThreadPool&&) = delete;
+
+		explicit ThreadPool(uint32_t threadCount);
+		~ThreadPool();
+
+		// Process wide pool sized to the number of hardware threads.
+		static ThreadPool& Shared();
+
+		uint32_t ThreadCount() const { return static_cast<uint32_t>(workers_.size()); }
+
+		template <class Function>
+		std::future<std::invoke_result_t<Function>> Submit(Function&& function)
+		{
+			using Result = std::invoke_result_t<Function>;
+
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+			auto future = task->get_future();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				tasks_.emplace([task]() { (*task)(); });
+			}
+
+			condition_.notify_one();
+			return future;
+		}
+
+	private:
+
+		void WorkerLoop();
+
+		std::vector<std::thread> workers_;
+		std::queue<std::function<void()>> tasks_;
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		bool stopping_{};
+	};
+
+}
@@ -0,0 +1,163 @@
+#include "Tracer.hpp"
+#include "AtomicFile.hpp"
+#include "Console.hpp"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Utilities {
+
+namespace
+{
+	struct Event
+	{
+		const char* Name;
+		int64_t Begin;
+		int64_t Duration;
+	};
+
+	// 64K zones per thread, minutes of frames before the oldest ones get overwritten.
+	constexpr uint64_t RingSize = 1 << 16;
+
+	struct ThreadRing
+	{
+		explicit ThreadRing(const uint32_t threadId) :
+			ThreadId(threadId),
+			Events(RingSize)
+		{
+		}
+
+		const uint32_t ThreadId;
+		std::vector<Event> Events;
+		std::atomic<uint64_t> Head{};
+	};
+
+	const auto Epoch = std::chrono::steady_clock::now();
+
+	std::atomic<bool> Enabled{};
+	std::mutex RegistryMutex;
+	std::vector<std::shared_ptr<ThreadRing>> Registry;
+
+	int64_t Now() noexcept
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch).count();
+	}
+
+	ThreadRing& LocalRing()
+	{
+		thread_local const std::shared_ptr<ThreadRing> ring = []()
+		{
+			std::lock_guard<std::mutex> lock(RegistryMutex);
+			Registry.push_back(std::make_shared<ThreadRing>(static_cast<uint32_t>(Registry.size())));
+			return Registry.back();
+		}();
+
+		return *ring;
+	}
+}
+
+Tracer::Zone::Zone(const char* name) noexcept :
+	name_(Enabled.load(std::memory_order_relaxed) ? name : nullptr),
+	begin_(name_ != nullptr ? Now() : 0)
+{
+}
+
+Tracer::Zone::~Zone()
+{
+	if (name_ == nullptr)
+	{
+		return;
+	}
+
+	const auto end = Now();
+	auto& ring = LocalRing();
+
+	// Only this thread writes the ring, publishing the new head is enough for Dump() to see the event.
+	const auto head = ring.Head.load(std::memory_order_relaxed);
+	ring.Events[head % RingSize] = Event{ name_, begin_, end - begin_ };
+	ring.Head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::SetEnabled(const bool enabled)
+{
+	Enabled.store(enabled, std::memory_order_relaxed);
+
+	// Called from the main thread, register its ring first so that it shows up as thread 0.
+	if (enabled)
+	{
+		LocalRing();
+	}
+}
+
+bool Tracer::IsEnabled() noexcept
+{
+	return Enabled.load(std::memory_order_relaxed);
+}
+
+void Tracer::Dump(const std::string& filename)
+{
+	std::vector<std::shared_ptr<ThreadRing>> rings;
+	{
+		std::lock_guard<std::mutex> lock(RegistryMutex);
+		rings = Registry;
+	}
+
+	size_t eventCount = 0;
+
+	const bool written = AtomicFile::Write(filename, std::ios::out, [&](std::ofstream& out)
+	{
+		out << std::fixed << std::setprecision(3);
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+		for (const auto& ring : rings)
+		{
+			out << (eventCount == 0 ? "\n" : ",\n");
+			out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->ThreadId
+				<< ",\"args\":{\"name\":\"";
+			if (ring->ThreadId == 0)
+			{
+				out << "Main";
+			}
+			else
+			{
+				out << "Thread " << ring->ThreadId;
+			}
+			out << "\"}}";
+
+			// A thread still recording may overwrite the oldest events while they are written out, which only
+			// happens once its ring has wrapped around.
+			const auto head = ring->Head.load(std::memory_order_acquire);
+			const auto first = head > RingSize ? head - RingSize : 0;
+
+			for (auto i = first; i != head; ++i)
+			{
+				const auto& event = ring->Events[i % RingSize];
+
+				out << ",\n{\"name\":\"" << event.Name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->ThreadId
+					<< ",\"ts\":" << event.Begin / 1000.0 << ",\"dur\":" << event.Duration / 1000.0 << "}";
+			}
+
+			eventCount += head - first + 1;
+		}
+
+		out << "\n]}\n";
+	});
+
+	if (written)
+	{
+		std::cout << "- wrote " << eventCount << " trace events to '" << filename << "'" << std::endl;
+		return;
+	}
+
+	Console::Write(Severity::Warning, [&filename]()
+	{
+		std::cout << "WARNING: failed to write trace '" << filename << "'" << std::endl;
+	});
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Utilities
+{
+	// Scoped CPU zones. Every thread appends its finished zones to its own ring buffer, there is no lock on the
+	// recording path, only the first zone of a thread registers its ring. Dump() writes whatever the rings still
+	// hold as Chrome trace event JSON, which chrome://tracing and ui.perfetto.dev open directly.
+	class Tracer final
+	{
+	public:
+
+		class Zone final
+		{
+		public:
+
+			Zone(const Zone&) = delete;
+			Zone(Zone&&) = delete;
+			Zone& operator = (const Zone&) = delete;
+			Zone& operator = (Zone&&) = delete;
+
+			// The name is stored as is, it must be a string literal.
+			explicit Zone(const char* name) noexcept;
+			~Zone();
+
+		private:
+
+			const char* name_;
+			int64_t begin_;
+		};
+
+		static void SetEnabled(bool enabled);
+		static bool IsEnabled() noexcept;
+
+		static void Dump(const std::string& filename);
+	};
+}
+
+#define TRACE_ZONE_NAME_(line) traceZone##line
+#define TRACE_ZONE_NAME(line) TRACE_ZONE_NAME_(line)
+#define TRACE_ZONE(name) const Utilities::Tracer::Zone TRACE_ZONE_NAME(__LINE__)(name)
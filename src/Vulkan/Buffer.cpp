@@ -32,10 +32,9 @@ DeviceMemory Buffer::AllocateMemory(const VkMemoryPropertyFlags propertyFlags)
 
 DeviceMemory Buffer::AllocateMemory(const VkMemoryAllocateFlags allocateFlags, const VkMemoryPropertyFlags propertyFlags)
 {
-	const auto requirements = GetMemoryRequirements();
-	DeviceMemory memory(device_, requirements.size, requirements.memoryTypeBits, allocateFlags, propertyFlags);
+	DeviceMemory memory(device_, GetMemoryRequirements(), allocateFlags, propertyFlags, true);
 
-	Check(vkBindBufferMemory(device_.Handle(), buffer_, memory.Handle(), 0),
+	Check(vkBindBufferMemory(device_.Handle(), buffer_, memory.Handle(), memory.Offset()),
 		"bind buffer memory");
 
 	return memory;
@@ -4,6 +4,7 @@
 #include "CommandPool.hpp"
 #include "Device.hpp"
 #include "DeviceMemory.hpp"
+#include "UploadManager.hpp"
 #include <cstring>
 #include <memory>
 #include <string>
@@ -27,6 +28,27 @@ namespace Vulkan
 			const std::vector<T>& content,
 			std::unique_ptr<Buffer>& buffer,
 			std::unique_ptr<DeviceMemory>& memory);
+
+		// Same as above, but the content goes through the upload manager's batched copies.
+		template <class T>
+		static void CreateDeviceBuffer(
+			UploadManager& uploads,
+			const char* name,
+			VkBufferUsageFlags usage,
+			const std::vector<T>& content,
+			std::unique_ptr<Buffer>& buffer,
+			std::unique_ptr<DeviceMemory>& memory);
+
+	private:
+
+		template <class T>
+		static void AllocateDeviceBuffer(
+			const Device& device,
+			const char* name,
+			VkBufferUsageFlags usage,
+			const std::vector<T>& content,
+			std::unique_ptr<Buffer>& buffer,
+			std::unique_ptr<DeviceMemory>& memory);
 	};
 
 	template <class T>
@@ -60,7 +82,40 @@ namespace Vulkan
 		std::unique_ptr<Buffer>& buffer,
 		std::unique_ptr<DeviceMemory>& memory)
 	{
-		const auto& device = commandPool.Device();
+		AllocateDeviceBuffer(commandPool.Device(), name, usage, content, buffer, memory);
+
+		if(content.size() > 0)
+		{
+			CopyFromStagingBuffer(commandPool, *buffer, content);
+		}
+	}
+
+	template <class T>
+	void BufferUtil::CreateDeviceBuffer(
+		UploadManager& uploads,
+		const char* const name,
+		const VkBufferUsageFlags usage,
+		const std::vector<T>& content,
+		std::unique_ptr<Buffer>& buffer,
+		std::unique_ptr<DeviceMemory>& memory)
+	{
+		AllocateDeviceBuffer(uploads.Device(), name, usage, content, buffer, memory);
+
+		if(content.size() > 0)
+		{
+			uploads.UploadBuffer(*buffer, content.data(), sizeof(T) * content.size());
+		}
+	}
+
+	template <class T>
+	void BufferUtil::AllocateDeviceBuffer(
+		const Device& device,
+		const char* const name,
+		const VkBufferUsageFlags usage,
+		const std::vector<T>& content,
+		std::unique_ptr<Buffer>& buffer,
+		std::unique_ptr<DeviceMemory>& memory)
+	{
 		const auto& debugUtils = device.DebugUtils();
 		const auto contentSize = sizeof(T) * (content.size() == 0 ? 1 : content.size()); // judge if contentSize == 0
 		const VkMemoryAllocateFlags allocateFlags = usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
@@ -71,11 +126,6 @@ namespace Vulkan
 		memory.reset(new DeviceMemory(buffer->AllocateMemory(allocateFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 
 		debugUtils.SetObjectName(buffer->Handle(), (name + std::string(" Buffer")).c_str());
-		debugUtils.SetObjectName(memory->Handle(), (name + std::string(" Memory")).c_str());
-
-		if(content.size() > 0)
-		{
-			CopyFromStagingBuffer(commandPool, *buffer, content);
-		}
+		memory->SetName(name);
 	}
 }
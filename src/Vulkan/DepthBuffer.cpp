@@ -56,7 +56,7 @@ namespace Vulkan {
 		const auto& debugUtils = device.DebugUtils();
 
 		debugUtils.SetObjectName(image_->Handle(), "Depth Buffer Image");
-		debugUtils.SetObjectName(imageMemory_->Handle(), "Depth Buffer Image Memory");
+		imageMemory_->SetName("Depth Buffer Image");
 		debugUtils.SetObjectName(imageView_->Handle(), "Depth Buffer ImageView");
 	}
 
@@ -8,14 +8,15 @@
 
 namespace Vulkan {
 
-DescriptorSetManager::DescriptorSetManager(const Device& device, const std::vector<DescriptorBinding>& descriptorBindings, const size_t maxSets)
+DescriptorSetManager::DescriptorSetManager(const Device& device, const std::vector<DescriptorBinding>& descriptorBindings, const size_t maxSets) :
+	device_(device),
+	descriptorBindings_(descriptorBindings),
+	maxSets_(maxSets)
 {
 	// Sanity check to avoid binding different resources to the same binding point.
-	std::map<uint32_t, VkDescriptorType> bindingTypes;
-
 	for (const auto& binding : descriptorBindings)
 	{
-		if (!bindingTypes.insert(std::make_pair(binding.Binding, binding.Type)).second)
+		if (!bindingTypes_.insert(std::make_pair(binding.Binding, binding.Type)).second)
 		{
 			Throw(std::invalid_argument("binding collision"));
 		}
@@ -23,7 +24,7 @@ DescriptorSetManager::DescriptorSetManager(const Device& device, const std::vect
 
 	descriptorPool_.reset(new DescriptorPool(device, descriptorBindings, maxSets));
 	descriptorSetLayout_.reset(new class DescriptorSetLayout(device, descriptorBindings));
-	descriptorSets_.reset(new class DescriptorSets(*descriptorPool_, *descriptorSetLayout_, bindingTypes, maxSets));
+	descriptorSets_.reset(new class DescriptorSets(*descriptorPool_, *descriptorSetLayout_, bindingTypes_, maxSets));
 }
 
 DescriptorSetManager::~DescriptorSetManager()
@@ -33,4 +34,19 @@ DescriptorSetManager::~DescriptorSetManager()
 	descriptorPool_.reset();
 }
 
+void DescriptorSetManager::Reallocate(const size_t maxSets)
+{
+	if (maxSets == maxSets_)
+	{
+		return;
+	}
+
+	descriptorSets_.reset();
+	descriptorPool_.reset();
+
+	maxSets_ = maxSets;
+	descriptorPool_.reset(new DescriptorPool(device_, descriptorBindings_, maxSets));
+	descriptorSets_.reset(new class DescriptorSets(*descriptorPool_, *descriptorSetLayout_, bindingTypes_, maxSets));
+}
+
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DescriptorBinding.hpp"
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -22,9 +23,18 @@ namespace Vulkan
 
 		const class DescriptorSetLayout& DescriptorSetLayout() const { return *descriptorSetLayout_; }
 		class DescriptorSets& DescriptorSets() { return *descriptorSets_; }
+		size_t MaxSets() const { return maxSets_; }
+
+		// Reallocates the pool and the sets for a new set count. The layout is kept, so are the pipeline layouts built on it.
+		void Reallocate(size_t maxSets);
 
 	private:
 
+		const class Device& device_;
+		const std::vector<DescriptorBinding> descriptorBindings_;
+		std::map<uint32_t, VkDescriptorType> bindingTypes_;
+		size_t maxSets_;
+
 		std::unique_ptr<DescriptorPool> descriptorPool_;
 		std::unique_ptr<class DescriptorSetLayout> descriptorSetLayout_;
 		std::unique_ptr<class DescriptorSets> descriptorSets_;
@@ -1,6 +1,8 @@
 #include "Device.hpp"
 #include "Enumerate.hpp"
 #include "Instance.hpp"
+#include "MemoryAllocator.hpp"
+#include "PipelineCache.hpp"
 #include "Surface.hpp"
 #include "Utilities/Exception.hpp"
 #include <algorithm>
@@ -56,8 +58,9 @@ Device::Device(
 	//and causes problems with RADV (see https://github.com/NVIDIA/Q2RTX/issues/147).
 	//const auto transferFamily = FindQueue(queueFamilies, "transfer", VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
 
-	// Find the presentation queue (usually the same as graphics queue).
-	const auto presentFamily = std::find_if(queueFamilies.begin(), queueFamilies.end(), [&](const VkQueueFamilyProperties& queueFamily)
+	// Find the presentation queue (usually the same as graphics queue). Without a surface there is nothing to present
+	// to, the graphics queue stands in for it.
+	const auto presentFamily = surface.Handle() == nullptr ? graphicsFamily : std::find_if(queueFamilies.begin(), queueFamilies.end(), [&](const VkQueueFamilyProperties& queueFamily)
 	{
 		VkBool32 presentSupport = false;
 		const uint32_t i = static_cast<uint32_t>(&*queueFamilies.cbegin() - &queueFamily);
@@ -115,6 +118,7 @@ Device::Device(
 		"create logical device");
 
 	debugUtils_.SetDevice(device_);
+	allocator_.reset(new MemoryAllocator(*this));
 
 	vkGetDeviceQueue(device_, graphicsFamilyIndex_, 0, &graphicsQueue_);
 	vkGetDeviceQueue(device_, computeFamilyIndex_, 0, &computeQueue_);
@@ -124,6 +128,9 @@ Device::Device(
 
 Device::~Device()
 {
+	pipelineCache_.reset();
+	allocator_.reset();
+
 	if (device_ != nullptr)
 	{
 		vkDestroyDevice(device_, nullptr);
@@ -131,6 +138,24 @@ Device::~Device()
 	}
 }
 
+VkPipelineCache Device::PipelineCache() const
+{
+	return pipelineCache_ ? pipelineCache_->Handle() : VK_NULL_HANDLE;
+}
+
+void Device::LoadPipelineCache(const std::string& filename)
+{
+	pipelineCache_.reset(new class PipelineCache(*this, filename));
+}
+
+void Device::SavePipelineCache() const
+{
+	if (pipelineCache_)
+	{
+		pipelineCache_->Save();
+	}
+}
+
 void Device::WaitIdle() const
 {
 	Check(vkDeviceWaitIdle(device_),
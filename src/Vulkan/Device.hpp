@@ -2,6 +2,8 @@
 
 #include "DebugUtils.hpp"
 #include "Vulkan.hpp"
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace Vulkan
@@ -27,6 +29,12 @@ namespace Vulkan
 		const class Surface& Surface() const { return surface_; }
 
 		const class DebugUtils& DebugUtils() const { return debugUtils_; }
+		class MemoryAllocator& Allocator() const { return *allocator_; }
+
+		// Pass to every vkCreate*Pipelines call, VK_NULL_HANDLE until LoadPipelineCache() has been called.
+		VkPipelineCache PipelineCache() const;
+		void LoadPipelineCache(const std::string& filename);
+		void SavePipelineCache() const;
 
 		uint32_t GraphicsFamilyIndex() const { return graphicsFamilyIndex_; }
 		uint32_t ComputeFamilyIndex() const { return computeFamilyIndex_; }
@@ -50,6 +58,8 @@ namespace Vulkan
 		VULKAN_HANDLE(VkDevice, device_)
 
 		class DebugUtils debugUtils_;
+		std::unique_ptr<class MemoryAllocator> allocator_;
+		std::unique_ptr<class PipelineCache> pipelineCache_;
 
 		uint32_t graphicsFamilyIndex_ {};
 		uint32_t computeFamilyIndex_{};
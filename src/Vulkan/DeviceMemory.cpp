@@ -6,71 +6,49 @@ namespace Vulkan {
 
 DeviceMemory::DeviceMemory(
 	const class Device& device, 
-	const size_t size, 
-	const uint32_t memoryTypeBits,
+	const VkMemoryRequirements& requirements,
 	const VkMemoryAllocateFlags allocateFLags,
-	const VkMemoryPropertyFlags propertyFlags) :
-	device_(device)
+	const VkMemoryPropertyFlags propertyFlags,
+	const bool linear) :
+	device_(device),
+	allocation_(device.Allocator().Allocate(requirements, allocateFLags, propertyFlags, linear))
 {
-	VkMemoryAllocateFlagsInfo flagsInfo = {};
-	flagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-	flagsInfo.pNext = nullptr;
-	flagsInfo.flags = allocateFLags;
-	
-	VkMemoryAllocateInfo allocInfo = {};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.pNext = &flagsInfo;
-	allocInfo.allocationSize = size;
-	allocInfo.memoryTypeIndex = FindMemoryType(memoryTypeBits, propertyFlags);
-
-	Check(vkAllocateMemory(device.Handle(), &allocInfo, nullptr, &memory_),
-		"allocate memory");
 }
 
 DeviceMemory::DeviceMemory(DeviceMemory&& other) noexcept :
 	device_(other.device_),
-	memory_(other.memory_)
+	allocation_(std::move(other.allocation_))
 {
-	other.memory_ = nullptr;
+	other.allocation_.Memory = nullptr;
 }
 
 DeviceMemory::~DeviceMemory()
 {
-	if (memory_ != nullptr)
+	if (allocation_.Memory != nullptr)
 	{
-		vkFreeMemory(device_.Handle(), memory_, nullptr);
-		memory_ = nullptr;
+		device_.Allocator().Free(allocation_);
+		allocation_.Memory = nullptr;
 	}
 }
 
-void* DeviceMemory::Map(const size_t offset, const size_t size)
+void DeviceMemory::SetName(const std::string& name)
 {
-	void* data;
-	Check(vkMapMemory(device_.Handle(), memory_, offset, size, 0, &data),
-		"map memory");
+	device_.Allocator().Rename(allocation_, name);
 
-	return data;
+	if (allocation_.Block < 0)
+	{
+		device_.DebugUtils().SetObjectName(allocation_.Memory, (name + " Memory").c_str());
+	}
 }
 
-void DeviceMemory::Unmap()
+void* DeviceMemory::Map(const size_t offset, const size_t size)
 {
-	vkUnmapMemory(device_.Handle(), memory_);
+	return static_cast<char*>(device_.Allocator().Map(allocation_)) + offset;
 }
 
-uint32_t DeviceMemory::FindMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags propertyFlags) const
+void DeviceMemory::Unmap()
 {
-	VkPhysicalDeviceMemoryProperties memProperties;
-	vkGetPhysicalDeviceMemoryProperties(device_.PhysicalDevice(), &memProperties);
-
-	for (uint32_t i = 0; i != memProperties.memoryTypeCount; ++i)
-	{
-		if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & propertyFlags) == propertyFlags)
-		{
-			return i;
-		}
-	}
-
-	Throw(std::runtime_error("failed to find suitable memory type"));
+	device_.Allocator().Unmap(allocation_);
 }
 
 }
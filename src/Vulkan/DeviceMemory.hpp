@@ -1,11 +1,15 @@
 #pragma once
 
 #include "Vulkan.hpp"
+#include "MemoryAllocator.hpp"
+#include <string>
 
 namespace Vulkan
 {
 	class Device;
 
+	// A range of device memory handed out by the device's MemoryAllocator. Several DeviceMemory objects
+	// may share the same VkDeviceMemory, resources have to be bound at Offset().
 	class DeviceMemory final
 	{
 	public:
@@ -14,22 +18,25 @@ namespace Vulkan
 		DeviceMemory& operator = (const DeviceMemory&) = delete;
 		DeviceMemory& operator = (DeviceMemory&&) = delete;
 
-		DeviceMemory(const Device& device, size_t size, uint32_t memoryTypeBits, VkMemoryAllocateFlags allocateFLags, VkMemoryPropertyFlags propertyFlags);
+		DeviceMemory(const Device& device, const VkMemoryRequirements& requirements, VkMemoryAllocateFlags allocateFLags, VkMemoryPropertyFlags propertyFlags, bool linear);
 		DeviceMemory(DeviceMemory&& other) noexcept;
 		~DeviceMemory();
 
 		const class Device& Device() const { return device_; }
+		VkDeviceMemory Handle() const { return allocation_.Memory; }
+		VkDeviceSize Offset() const { return allocation_.Offset; }
+
+		// Names the allocation for the allocator statistics (and the debugger when it owns its VkDeviceMemory).
+		void SetName(const std::string& name);
 
 		void* Map(size_t offset, size_t size);
 		void Unmap();
 
 	private:
 
-		uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
-
 		const class Device& device_;
 
-		VULKAN_HANDLE(VkDeviceMemory, memory_)
+		MemoryAllocator::Allocation allocation_;
 	};
 
 }
@@ -0,0 +1,157 @@
+#include "GpuProfiler.hpp"
+#include "Device.hpp"
+#include "Enumerate.hpp"
+#include "QueryPool.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace Vulkan {
+
+GpuProfiler::GpuProfiler(const class Device& device) :
+	device_(device)
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties);
+
+	const auto queueFamilies = GetEnumerateVector(device.PhysicalDevice(), vkGetPhysicalDeviceQueueFamilyProperties);
+	const auto validBits = queueFamilies[device.GraphicsFamilyIndex()].timestampValidBits;
+
+	if (validBits == 0)
+	{
+		return;
+	}
+
+	timestampMask_ = validBits >= 64 ? ~uint64_t(0) : (uint64_t(1) << validBits) - 1;
+	timestampPeriodMs_ = properties.limits.timestampPeriod / 1000000.0;
+
+	for (auto& frame : frames_)
+	{
+		frame.Queries.reset(new QueryPool(device, VK_QUERY_TYPE_TIMESTAMP, MaxZones * 2));
+	}
+}
+
+GpuProfiler::~GpuProfiler()
+{
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer)
+{
+	if (!IsSupported())
+	{
+		return;
+	}
+
+	currentFrame_ = (currentFrame_ + 1) % FramesInFlight;
+	auto& frame = frames_[currentFrame_];
+
+	// This pool was submitted FramesInFlight frames ago, its results are long available.
+	if (frame.Pending)
+	{
+		Collect(frame);
+	}
+
+	frame.Queries->Reset(commandBuffer);
+	frame.ZoneIndices.clear();
+	frame.Pending = true;
+	openZones_.clear();
+}
+
+void GpuProfiler::BeginZone(VkCommandBuffer commandBuffer, const char* name)
+{
+	if (!IsSupported())
+	{
+		return;
+	}
+
+	auto& frame = frames_[currentFrame_];
+
+	if (frame.ZoneIndices.size() == MaxZones)
+	{
+		openZones_.push_back(MaxZones);
+		return;
+	}
+
+	const auto entry = static_cast<uint32_t>(frame.ZoneIndices.size());
+	frame.ZoneIndices.push_back(FindOrAddZone(name));
+	openZones_.push_back(entry);
+
+	// Bottom of pipe on both ends, so that back to back zones split the frame instead of overlapping.
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.Queries->Handle(), entry * 2);
+}
+
+void GpuProfiler::EndZone(VkCommandBuffer commandBuffer)
+{
+	if (!IsSupported() || openZones_.empty())
+	{
+		return;
+	}
+
+	const auto entry = openZones_.back();
+	openZones_.pop_back();
+
+	if (entry != MaxZones)
+	{
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frames_[currentFrame_].Queries->Handle(), entry * 2 + 1);
+	}
+}
+
+void GpuProfiler::ResetTotals()
+{
+	for (auto& zone : zones_)
+	{
+		zone.TotalMs = 0;
+		zone.Samples = 0;
+	}
+}
+
+void GpuProfiler::Collect(FrameQueries& frame)
+{
+	frame.Pending = false;
+
+	const auto queryCount = static_cast<uint32_t>(frame.ZoneIndices.size() * 2);
+
+	// A zone left open or a device that is late by a whole ring simply loses this sample.
+	if (queryCount == 0 || !frame.Queries->TryGetResults(queryCount, results_))
+	{
+		return;
+	}
+
+	// Exponential moving average, roughly the last 30 frames.
+	const double smoothing = 1.0 / 30.0;
+	uint64_t frameEnd = 0;
+
+	for (size_t i = 0; i != frame.ZoneIndices.size(); ++i)
+	{
+		const auto begin = results_[i * 2] & timestampMask_;
+		const auto end = results_[i * 2 + 1] & timestampMask_;
+		const double ms = static_cast<double>((end - begin) & timestampMask_) * timestampPeriodMs_;
+
+		auto& zone = zones_[frame.ZoneIndices[i]];
+		zone.AverageMs = zone.AverageMs == 0 ? ms : zone.AverageMs + (ms - zone.AverageMs) * smoothing;
+		zone.TotalMs += ms;
+		zone.Samples++;
+
+		frameEnd = std::max(frameEnd, (end - (results_[0] & timestampMask_)) & timestampMask_);
+	}
+
+	const double frameMs = static_cast<double>(frameEnd) * timestampPeriodMs_;
+	frameAverageMs_ = frameAverageMs_ == 0 ? frameMs : frameAverageMs_ + (frameMs - frameAverageMs_) * smoothing;
+}
+
+uint32_t GpuProfiler::FindOrAddZone(const char* name)
+{
+	const auto zone = std::find_if(zones_.begin(), zones_.end(), [name](const Zone& zone)
+	{
+		return std::strcmp(zone.Name.c_str(), name) == 0;
+	});
+
+	if (zone != zones_.end())
+	{
+		return static_cast<uint32_t>(zone - zones_.begin());
+	}
+
+	zones_.push_back(Zone{ name, 0, 0, 0 });
+	return static_cast<uint32_t>(zones_.size() - 1);
+}
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Vulkan
+{
+	class Device;
+	class QueryPool;
+
+	// Timestamp queries around the render passes. Each frame records into its own query pool of a small ring,
+	// and the results of a pool are only read back when the ring comes around to it again, so reading them
+	// never waits on the GPU.
+	class GpuProfiler final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(GpuProfiler)
+
+		struct Zone
+		{
+			std::string Name;
+			double AverageMs;
+			double TotalMs;
+			uint32_t Samples;
+		};
+
+		explicit GpuProfiler(const Device& device);
+		~GpuProfiler();
+
+		bool IsSupported() const { return timestampMask_ != 0; }
+
+		// Must be recorded outside of a render pass, before any zone of the frame.
+		void BeginFrame(VkCommandBuffer commandBuffer);
+		void BeginZone(VkCommandBuffer commandBuffer, const char* name);
+		void EndZone(VkCommandBuffer commandBuffer);
+
+		// Zones in the order they were first seen. AverageMs is smoothed over the last frames, TotalMs / Samples
+		// covers everything since the last ResetTotals().
+		const std::vector<Zone>& Zones() const { return zones_; }
+		double FrameAverageMs() const { return frameAverageMs_; }
+		void ResetTotals();
+
+	private:
+
+		// DrawFrame() waits on the previous frame before recording, three pools are enough to never catch one in flight.
+		static constexpr size_t FramesInFlight = 3;
+		static constexpr uint32_t MaxZones = 32;
+
+		struct FrameQueries
+		{
+			std::unique_ptr<class QueryPool> Queries;
+			// Zone of each begin / end query pair.
+			std::vector<uint32_t> ZoneIndices;
+			bool Pending{};
+		};
+
+		void Collect(FrameQueries& frame);
+		uint32_t FindOrAddZone(const char* name);
+
+		const class Device& device_;
+
+		uint64_t timestampMask_{};
+		double timestampPeriodMs_{};
+
+		std::array<FrameQueries, FramesInFlight> frames_;
+		size_t currentFrame_{};
+		std::vector<uint32_t> openZones_;
+
+		std::vector<Zone> zones_;
+		double frameAverageMs_{};
+		std::vector<uint64_t> results_;
+	};
+
+}
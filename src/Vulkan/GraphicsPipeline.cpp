@@ -24,8 +24,12 @@ GraphicsPipeline::GraphicsPipeline(
 	isWireFrame_(isWireFrame)
 {
 	const auto& device = swapChain.Device();
-	const auto bindingDescription = Assets::Vertex::GetBindingDescription();
-	const auto attributeDescriptions = Assets::Vertex::GetAttributeDescriptions();
+	const auto bindingDescription = scene.CompactVertices()
+		? Assets::CompactVertex::GetBindingDescription()
+		: Assets::Vertex::GetBindingDescription();
+	const auto attributeDescriptions = scene.CompactVertices()
+		? Assets::CompactVertex::GetAttributeDescriptions()
+		: Assets::Vertex::GetAttributeDescriptions();
 
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -118,7 +122,8 @@ GraphicsPipeline::GraphicsPipeline(
 	{
 		{0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT},
 		{1, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT},
-		{2, static_cast<uint32_t>(scene.TextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT}
+		{2, static_cast<uint32_t>(scene.TextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT},
+		{3, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT}
 	};
 
 	descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
@@ -137,6 +142,11 @@ GraphicsPipeline::GraphicsPipeline(
 		materialBufferInfo.buffer = scene.MaterialBuffer().Handle();
 		materialBufferInfo.range = VK_WHOLE_SIZE;
 
+		// Node buffer
+		VkDescriptorBufferInfo nodesBufferInfo = {};
+		nodesBufferInfo.buffer = scene.NodeMatrixBuffer().Handle();
+		nodesBufferInfo.range = VK_WHOLE_SIZE;
+
 		// Image and texture samplers
 		std::vector<VkDescriptorImageInfo> imageInfos(scene.TextureSamplers().size());
 
@@ -152,7 +162,8 @@ GraphicsPipeline::GraphicsPipeline(
 		{
 			descriptorSets.Bind(i, 0, uniformBufferInfo),
 			descriptorSets.Bind(i, 1, materialBufferInfo),
-			descriptorSets.Bind(i, 2, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size()))
+			descriptorSets.Bind(i, 2, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size())),
+			descriptorSets.Bind(i, 3, nodesBufferInfo)
 		};
 
 		descriptorSets.UpdateDescriptors(i, descriptorWrites);
@@ -169,7 +180,7 @@ GraphicsPipeline::GraphicsPipeline(
 
 	VkPipelineShaderStageCreateInfo shaderStages[] =
 	{
-		vertShader.CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT),
+		vertShader.CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT, scene.VertexSpecialization()),
 		fragShader.CreateShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT)
 	};
 
@@ -192,7 +203,7 @@ GraphicsPipeline::GraphicsPipeline(
 	pipelineInfo.renderPass = renderPass_->Handle();
 	pipelineInfo.subpass = 0;
 
-	Check(vkCreateGraphicsPipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
+	Check(vkCreateGraphicsPipelines(device.Handle(), device.PipelineCache(), 1, &pipelineInfo, nullptr, &pipeline_),
 		"create graphics pipeline");
 }
 
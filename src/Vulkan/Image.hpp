@@ -32,11 +32,16 @@ namespace Vulkan
 		void TransitionImageLayout(CommandPool& commandPool, VkImageLayout newLayout);
 		void CopyFrom(CommandPool& commandPool, const Buffer& buffer);
 
+		// Record into an existing command buffer instead of a single time submit.
+		void TransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout);
+		void CopyFrom(VkCommandBuffer commandBuffer, const Buffer& buffer, VkDeviceSize bufferOffset);
+
 	private:
 
 		const class Device& device_;
 		const VkExtent2D extent_;
 		const VkFormat format_;
+		const VkImageTiling tiling_;
 		VkImageLayout imageLayout_;
 
 		VULKAN_HANDLE(VkImage, image_)
@@ -23,8 +23,12 @@ GBufferPipeline::GBufferPipeline(
 	swapChain_(swapChain)
 {
 	const auto& device = swapChain.Device();
-	const auto bindingDescription = Assets::Vertex::GetBindingDescription();
-	const auto attributeDescriptions = Assets::Vertex::GetAttributeDescriptions();
+	const auto bindingDescription = scene.CompactVertices()
+		? Assets::CompactVertex::GetBindingDescription()
+		: Assets::Vertex::GetBindingDescription();
+	const auto attributeDescriptions = scene.CompactVertices()
+		? Assets::CompactVertex::GetAttributeDescriptions()
+		: Assets::Vertex::GetAttributeDescriptions();
 
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -182,7 +186,7 @@ GBufferPipeline::GBufferPipeline(
 
 	VkPipelineShaderStageCreateInfo shaderStages[] =
 	{
-		vertShader.CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT),
+		vertShader.CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT, scene.VertexSpecialization()),
 		fragShader.CreateShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT)
 	};
 
@@ -205,7 +209,7 @@ GBufferPipeline::GBufferPipeline(
 	pipelineInfo.renderPass = renderPass_->Handle();
 	pipelineInfo.subpass = 0;
 
-	Check(vkCreateGraphicsPipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
+	Check(vkCreateGraphicsPipelines(device.Handle(), device.PipelineCache(), 1, &pipelineInfo, nullptr, &pipeline_),
 		"create graphics pipeline");
 }
 
@@ -227,14 +231,9 @@ VkDescriptorSet GBufferPipeline::DescriptorSet(const uint32_t index) const
 	return descriptorSetManager_->DescriptorSets().Handle(index);
 }
 
-ShadingPipeline::ShadingPipeline(const SwapChain& swapChain, const ImageView& gbuffer0ImageView,
-	const ImageView& gbuffer1ImageView,
-	const ImageView& gbuffer2ImageView,
-	const ImageView& finalImageView,
-	const std::vector<Assets::UniformBuffer>& uniformBuffers, const Assets::Scene& scene):swapChain_(swapChain)
+ShadingPipeline::ShadingPipeline(const Device& device, const size_t descriptorSetCount):device_(device)
 {
 	 // Create descriptor pool/sets.
-        const auto& device = swapChain.Device();
         const std::vector<DescriptorBinding> descriptorBindings =
         {
             // MiniGbuffer and output
@@ -248,11 +247,45 @@ ShadingPipeline::ShadingPipeline(const SwapChain& swapChain, const ImageView& gb
 			{4, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},
         };
 
-        descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
+        descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, descriptorSetCount));
+
+        pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
+        const ShaderModule denoiseShader(device, "../assets/shaders/LegacyDeferredShading.comp.spv");
+
+        VkComputePipelineCreateInfo pipelineCreateInfo = {};
+        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.stage = denoiseShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT);
+        pipelineCreateInfo.layout = pipelineLayout_->Handle();
+	
+        Check(vkCreateComputePipelines(device.Handle(), device.PipelineCache(),
+                                       1, &pipelineCreateInfo,
+                                       NULL, &pipeline_),
+              "create deferred shading pipeline");
+}
+
+ShadingPipeline::~ShadingPipeline()
+{
+	if (pipeline_ != nullptr)
+	{
+		vkDestroyPipeline(device_.Handle(), pipeline_, nullptr);
+		pipeline_ = nullptr;
+	}
+
+	pipelineLayout_.reset();
+	descriptorSetManager_.reset();
+}
+
+void ShadingPipeline::UpdateDescriptors(const ImageView& gbuffer0ImageView,
+	const ImageView& gbuffer1ImageView,
+	const ImageView& gbuffer2ImageView,
+	const ImageView& finalImageView,
+	const std::vector<Assets::UniformBuffer>& uniformBuffers)
+{
+        descriptorSetManager_->Reallocate(uniformBuffers.size());
 
         auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
-        for (uint32_t i = 0; i != swapChain.Images().size(); ++i)
+        for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
         {
             VkDescriptorImageInfo Info0 = {NULL,  gbuffer0ImageView.Handle(), VK_IMAGE_LAYOUT_GENERAL};
         	VkDescriptorImageInfo Info1 = {NULL,  gbuffer1ImageView.Handle(), VK_IMAGE_LAYOUT_GENERAL};
@@ -275,31 +308,6 @@ ShadingPipeline::ShadingPipeline(const SwapChain& swapChain, const ImageView& gb
 
             descriptorSets.UpdateDescriptors(i, descriptorWrites);
         }
-
-        pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
-        const ShaderModule denoiseShader(device, "../assets/shaders/LegacyDeferredShading.comp.spv");
-
-        VkComputePipelineCreateInfo pipelineCreateInfo = {};
-        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-        pipelineCreateInfo.stage = denoiseShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT);
-        pipelineCreateInfo.layout = pipelineLayout_->Handle();
-	
-        Check(vkCreateComputePipelines(device.Handle(), VK_NULL_HANDLE,
-                                       1, &pipelineCreateInfo,
-                                       NULL, &pipeline_),
-              "create deferred shading pipeline");
-}
-
-ShadingPipeline::~ShadingPipeline()
-{
-	if (pipeline_ != nullptr)
-	{
-		vkDestroyPipeline(swapChain_.Device().Handle(), pipeline_, nullptr);
-		pipeline_ = nullptr;
-	}
-
-	pipelineLayout_.reset();
-	descriptorSetManager_.reset();
 }
 
 VkDescriptorSet ShadingPipeline::DescriptorSet(uint32_t index) const
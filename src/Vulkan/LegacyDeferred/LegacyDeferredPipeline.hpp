@@ -14,6 +14,7 @@ namespace Assets
 namespace Vulkan
 {
 	class DepthBuffer;
+	class Device;
 	class PipelineLayout;
 	class RenderPass;
 	class SwapChain;
@@ -56,20 +57,20 @@ namespace Vulkan::LegacyDeferred
 	public:
 		VULKAN_NON_COPIABLE(ShadingPipeline)
 	
-		ShadingPipeline(
-			const SwapChain& swapChain, 
+		ShadingPipeline(const Device& device, size_t descriptorSetCount);
+		~ShadingPipeline();
+
+		void UpdateDescriptors(
 			const ImageView& gbuffer0ImageView,
 			const ImageView& gbuffer1ImageView,
 			const ImageView& gbuffer2ImageView,
 			const ImageView& finalImageView,
-			const std::vector<Assets::UniformBuffer>& uniformBuffers,
-			const Assets::Scene& scene);
-		~ShadingPipeline();
+			const std::vector<Assets::UniformBuffer>& uniformBuffers);
 
 		VkDescriptorSet DescriptorSet(uint32_t index) const;
 		const Vulkan::PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 	private:
-		const SwapChain& swapChain_;
+		const Device& device_;
 		
 		VULKAN_HANDLE(VkPipeline, pipeline_)
 
@@ -4,6 +4,7 @@
 #include "Vulkan/Buffer.hpp"
 #include "Vulkan/Device.hpp"
 #include "Vulkan/FrameBuffer.hpp"
+#include "Vulkan/GpuProfiler.hpp"
 #include "Vulkan/PipelineLayout.hpp"
 #include "Vulkan/RenderPass.hpp"
 #include "Vulkan/SwapChain.hpp"
@@ -26,6 +27,7 @@ LegacyDeferredRenderer::LegacyDeferredRenderer(const WindowConfig& windowConfig,
 LegacyDeferredRenderer::~LegacyDeferredRenderer()
 {
 	LegacyDeferredRenderer::DeleteSwapChain();
+	deferredShadingPipeline_.reset();
 }
 	
 void LegacyDeferredRenderer::CreateSwapChain()
@@ -75,10 +77,17 @@ void LegacyDeferredRenderer::CreateSwapChain()
 
 	// MRT
 	deferredFrameBuffer_.reset(new FrameBuffer(*gbufferBuffer0ImageView_, *gbufferBuffer1ImageView_, *gbufferBuffer2ImageView_, gbufferPipeline_->RenderPass()));
-	deferredShadingPipeline_.reset(new ShadingPipeline(SwapChain(), *gbufferBuffer0ImageView_,
+
+	// The shading pipeline outlives the swap chain, only its descriptors follow the new images.
+	if (!deferredShadingPipeline_)
+	{
+		deferredShadingPipeline_.reset(new ShadingPipeline(Device(), UniformBuffers().size()));
+	}
+
+	deferredShadingPipeline_->UpdateDescriptors(*gbufferBuffer0ImageView_,
 		*gbufferBuffer1ImageView_,
 		*gbufferBuffer2ImageView_,
-		*outputImageView_, UniformBuffers(), GetScene()));
+		*outputImageView_, UniformBuffers());
 
 	const auto& debugUtils = Device().DebugUtils();
 	debugUtils.SetObjectName(outputImage_->Handle(), "Output Image");
@@ -87,6 +96,11 @@ void LegacyDeferredRenderer::CreateSwapChain()
 	debugUtils.SetObjectName(gbuffer1BufferImage_->Handle(), "GBuffer1 Image");
 	debugUtils.SetObjectName(gbuffer2BufferImage_->Handle(), "GBuffer2 Image");
 
+	outputImageMemory_->SetName("Output Image");
+	gbufferBuffer0ImageMemory_->SetName("GBuffer Image");
+	gbufferBuffer1ImageMemory_->SetName("GBuffer Image");
+	gbufferBuffer2ImageMemory_->SetName("GBuffer Image");
+
 	debugUtils.SetObjectName(gbufferBuffer0ImageView_->Handle(), "GBuffer0 Image View");
 	debugUtils.SetObjectName(gbufferBuffer1ImageView_->Handle(), "GBuffer1 Image View");
 	debugUtils.SetObjectName(gbufferBuffer2ImageView_->Handle(), "GBuffer2 Image View");
@@ -95,7 +109,6 @@ void LegacyDeferredRenderer::CreateSwapChain()
 void LegacyDeferredRenderer::DeleteSwapChain()
 {
 	gbufferPipeline_.reset();
-	deferredShadingPipeline_.reset();
 	deferredFrameBuffer_.reset();
 
 	gbuffer0BufferImage_.reset();
@@ -135,6 +148,7 @@ void LegacyDeferredRenderer::Render(VkCommandBuffer commandBuffer, uint32_t imag
 	renderPassInfo.pClearValues = clearValues.data();
 
 	// make it to generate gbuffer
+	GpuProfiler().BeginZone(commandBuffer, "GBuffer");
 	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 	{
 		const auto& scene = GetScene();
@@ -170,6 +184,7 @@ void LegacyDeferredRenderer::Render(VkCommandBuffer commandBuffer, uint32_t imag
 		}
 	}
 	vkCmdEndRenderPass(commandBuffer);
+	GpuProfiler().EndZone(commandBuffer);
 
 	VkImageSubresourceRange subresourceRange = {};
 	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -191,13 +206,16 @@ void LegacyDeferredRenderer::Render(VkCommandBuffer commandBuffer, uint32_t imag
 				   0, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
 				   VK_IMAGE_LAYOUT_GENERAL);
 	// cs shading pass
+	GpuProfiler().BeginZone(commandBuffer, "Shading");
 	VkDescriptorSet denoiserDescriptorSets[] = {deferredShadingPipeline_->DescriptorSet(imageIndex)};
 	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, deferredShadingPipeline_->Handle());
 	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
 							deferredShadingPipeline_->PipelineLayout().Handle(), 0, 1, denoiserDescriptorSets, 0, nullptr);
 	vkCmdDispatch(commandBuffer, SwapChain().Extent().width / 8 / ( CheckerboxRendering() ? 2 : 1 ), SwapChain().Extent().height / 4, 1);
+	GpuProfiler().EndZone(commandBuffer);
 	
 	// copy to swap-buffer
+	GpuProfiler().BeginZone(commandBuffer, "Copy");
 	ImageMemoryBarrier::Insert(commandBuffer, outputImage_->Handle(), subresourceRange,
 						   VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
 						   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
@@ -222,5 +240,6 @@ void LegacyDeferredRenderer::Render(VkCommandBuffer commandBuffer, uint32_t imag
 	ImageMemoryBarrier::Insert(commandBuffer, SwapChain().Images()[imageIndex], subresourceRange,
 							   VK_ACCESS_TRANSFER_WRITE_BIT,
 							   0, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	GpuProfiler().EndZone(commandBuffer);
 }
 }
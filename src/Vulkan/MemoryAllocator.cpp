@@ -0,0 +1,318 @@
+#include "MemoryAllocator.hpp"
+#include "Device.hpp"
+#include "Utilities/Exception.hpp"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+namespace Vulkan {
+
+namespace
+{
+	const VkDeviceSize BlockSize = 64 * 1024 * 1024;
+
+	VkDeviceSize RoundUp(const VkDeviceSize size, const VkDeviceSize granularity)
+	{
+		return (size + granularity - 1) / granularity * granularity;
+	}
+}
+
+MemoryAllocator::MemoryAllocator(const class Device& device) :
+	device_(device)
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties);
+	vkGetPhysicalDeviceMemoryProperties(device.PhysicalDevice(), &memoryProperties_);
+
+	bufferImageGranularity_ = std::max<VkDeviceSize>(1, properties.limits.bufferImageGranularity);
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+	for (auto& block : blocks_)
+	{
+		if (block)
+		{
+			vkFreeMemory(device_.Handle(), block->Memory, nullptr);
+		}
+	}
+}
+
+MemoryAllocator::Allocation MemoryAllocator::Allocate(
+	const VkMemoryRequirements& requirements,
+	const VkMemoryAllocateFlags allocateFlags,
+	const VkMemoryPropertyFlags propertyFlags,
+	const bool linear)
+{
+	const uint32_t memoryType = FindMemoryType(requirements.memoryTypeBits, propertyFlags);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	Allocation allocation;
+	allocation.Name = "Unnamed";
+
+	if (requirements.size > BlockSize / 2)
+	{
+		allocation.Memory = AllocateDeviceMemory(requirements.size, memoryType, allocateFlags);
+		allocation.Size = requirements.size;
+	}
+	else
+	{
+		// Keep images a granularity page apart, whatever their tiling turns out to be.
+		const VkDeviceSize alignment = linear ? requirements.alignment : std::max(requirements.alignment, bufferImageGranularity_);
+		const VkDeviceSize size = linear ? requirements.size : RoundUp(requirements.size, bufferImageGranularity_);
+
+		int32_t found = -1;
+		for (size_t i = 0; i != blocks_.size() && found < 0; ++i)
+		{
+			auto& block = blocks_[i];
+			if (block && block->MemoryType == memoryType && block->AllocateFlags == allocateFlags && block->Linear == linear &&
+				TryAllocate(*block, size, alignment, allocation.Offset))
+			{
+				found = static_cast<int32_t>(i);
+			}
+		}
+
+		if (found < 0)
+		{
+			std::unique_ptr<Block> block(new Block());
+			block->Memory = AllocateDeviceMemory(BlockSize, memoryType, allocateFlags);
+			block->MemoryType = memoryType;
+			block->AllocateFlags = allocateFlags;
+			block->Linear = linear;
+			block->FreeRanges[0] = BlockSize;
+
+			TryAllocate(*block, size, alignment, allocation.Offset);
+
+			// Reuse the slot of a released block so indices stay small.
+			const auto slot = std::find(blocks_.begin(), blocks_.end(), nullptr);
+			found = static_cast<int32_t>(slot - blocks_.begin());
+			if (slot == blocks_.end())
+			{
+				blocks_.push_back(std::move(block));
+			}
+			else
+			{
+				*slot = std::move(block);
+			}
+		}
+
+		auto& block = *blocks_[found];
+		block.Allocations++;
+
+		allocation.Memory = block.Memory;
+		allocation.Size = size;
+		allocation.Block = found;
+	}
+
+	auto& statistics = statistics_[allocation.Name];
+	statistics.Count++;
+	statistics.Bytes += allocation.Size;
+
+	return allocation;
+}
+
+void MemoryAllocator::Free(const Allocation& allocation)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto& statistics = statistics_[allocation.Name];
+	statistics.Count--;
+	statistics.Bytes -= allocation.Size;
+
+	if (allocation.Block < 0)
+	{
+		FreeDeviceMemory(allocation.Memory, allocation.Size);
+		return;
+	}
+
+	auto& block = blocks_[allocation.Block];
+	Release(*block, allocation.Offset, allocation.Size);
+
+	if (--block->Allocations != 0)
+	{
+		return;
+	}
+
+	// Keep one empty block of each kind around, so a resource recreated right after being freed (swap chain
+	// images, per-frame buffers) does not hit vkAllocateMemory again. Any further empty block goes back to the driver.
+	const bool spare = std::any_of(blocks_.begin(), blocks_.end(), [&block](const std::unique_ptr<Block>& other)
+	{
+		return other && other != block && other->Allocations == 0 && other->MemoryType == block->MemoryType &&
+			other->AllocateFlags == block->AllocateFlags && other->Linear == block->Linear;
+	});
+
+	if (spare)
+	{
+		FreeDeviceMemory(block->Memory, BlockSize);
+		block.reset();
+	}
+}
+
+void* MemoryAllocator::Map(const Allocation& allocation)
+{
+	void* data;
+
+	if (allocation.Block < 0)
+	{
+		Check(vkMapMemory(device_.Handle(), allocation.Memory, 0, allocation.Size, 0, &data),
+			"map memory");
+
+		return data;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto& block = *blocks_[allocation.Block];
+	if (block.Mapped == nullptr)
+	{
+		Check(vkMapMemory(device_.Handle(), block.Memory, 0, VK_WHOLE_SIZE, 0, &block.Mapped),
+			"map memory");
+	}
+
+	return static_cast<char*>(block.Mapped) + allocation.Offset;
+}
+
+void MemoryAllocator::Unmap(const Allocation& allocation)
+{
+	if (allocation.Block < 0)
+	{
+		vkUnmapMemory(device_.Handle(), allocation.Memory);
+	}
+}
+
+void MemoryAllocator::Rename(Allocation& allocation, const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto& previous = statistics_[allocation.Name];
+	previous.Count--;
+	previous.Bytes -= allocation.Size;
+
+	auto& next = statistics_[name];
+	next.Count++;
+	next.Bytes += allocation.Size;
+
+	allocation.Name = name;
+}
+
+uint32_t MemoryAllocator::FindMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags propertyFlags) const
+{
+	for (uint32_t i = 0; i != memoryProperties_.memoryTypeCount; ++i)
+	{
+		if ((typeFilter & (1 << i)) && (memoryProperties_.memoryTypes[i].propertyFlags & propertyFlags) == propertyFlags)
+		{
+			return i;
+		}
+	}
+
+	Throw(std::runtime_error("failed to find suitable memory type"));
+}
+
+void MemoryAllocator::PrintStatistics() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	const auto megabytes = [](const VkDeviceSize bytes) { return static_cast<float>(bytes) / (1024 * 1024); };
+
+	std::cout << "- device memory: " << deviceMemoryCount_ << " allocations, " << megabytes(deviceMemoryBytes_) << " MB" << std::endl;
+
+	for (const auto& entry : statistics_)
+	{
+		if (entry.second.Count != 0)
+		{
+			std::cout << "  " << entry.first << ": " << entry.second.Count << " x, " << megabytes(entry.second.Bytes) << " MB" << std::endl;
+		}
+	}
+}
+
+VkDeviceMemory MemoryAllocator::AllocateDeviceMemory(const VkDeviceSize size, const uint32_t memoryType, const VkMemoryAllocateFlags allocateFlags)
+{
+	VkMemoryAllocateFlagsInfo flagsInfo = {};
+	flagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+	flagsInfo.pNext = nullptr;
+	flagsInfo.flags = allocateFlags;
+
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.pNext = &flagsInfo;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryType;
+
+	VkDeviceMemory memory;
+	Check(vkAllocateMemory(device_.Handle(), &allocInfo, nullptr, &memory),
+		"allocate memory");
+
+	deviceMemoryCount_++;
+	deviceMemoryBytes_ += size;
+
+	return memory;
+}
+
+void MemoryAllocator::FreeDeviceMemory(VkDeviceMemory memory, const VkDeviceSize size)
+{
+	vkFreeMemory(device_.Handle(), memory, nullptr);
+
+	deviceMemoryCount_--;
+	deviceMemoryBytes_ -= size;
+}
+
+bool MemoryAllocator::TryAllocate(Block& block, const VkDeviceSize size, const VkDeviceSize alignment, VkDeviceSize& offset)
+{
+	// First fit, the ranges are sorted by offset.
+	for (auto range = block.FreeRanges.begin(); range != block.FreeRanges.end(); ++range)
+	{
+		const VkDeviceSize rangeBegin = range->first;
+		const VkDeviceSize rangeEnd = range->first + range->second;
+		const VkDeviceSize begin = RoundUp(rangeBegin, alignment);
+
+		if (begin + size > rangeEnd)
+		{
+			continue;
+		}
+
+		block.FreeRanges.erase(range);
+
+		if (begin != rangeBegin)
+		{
+			block.FreeRanges[rangeBegin] = begin - rangeBegin;
+		}
+
+		if (begin + size != rangeEnd)
+		{
+			block.FreeRanges[begin + size] = rangeEnd - (begin + size);
+		}
+
+		offset = begin;
+		return true;
+	}
+
+	return false;
+}
+
+void MemoryAllocator::Release(Block& block, VkDeviceSize offset, VkDeviceSize size)
+{
+	// Merge with the free neighbours on both sides.
+	auto next = block.FreeRanges.lower_bound(offset);
+
+	if (next != block.FreeRanges.begin())
+	{
+		const auto previous = std::prev(next);
+		if (previous->first + previous->second == offset)
+		{
+			offset = previous->first;
+			size += previous->second;
+			block.FreeRanges.erase(previous);
+		}
+	}
+
+	if (next != block.FreeRanges.end() && offset + size == next->first)
+	{
+		size += next->second;
+		block.FreeRanges.erase(next);
+	}
+
+	block.FreeRanges[offset] = size;
+}
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Vulkan
+{
+	class Device;
+
+	// Sub-allocates buffer and image memory out of a few large blocks instead of one vkAllocateMemory per resource.
+	// Requests larger than half a block get a dedicated allocation. At most one empty block per kind is kept for reuse. Buffers (and linear images) never share a block
+	// with optimal tiling images, so bufferImageGranularity only has to be honoured between images.
+	class MemoryAllocator final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(MemoryAllocator)
+
+		struct Allocation
+		{
+			VkDeviceMemory Memory{};
+			VkDeviceSize Offset{};
+			VkDeviceSize Size{};
+			int32_t Block{-1}; // -1 for a dedicated allocation.
+			std::string Name;
+		};
+
+		explicit MemoryAllocator(const Device& device);
+		~MemoryAllocator();
+
+		Allocation Allocate(const VkMemoryRequirements& requirements, VkMemoryAllocateFlags allocateFlags, VkMemoryPropertyFlags propertyFlags, bool linear);
+		void Free(const Allocation& allocation);
+
+		// Blocks are mapped once and stay mapped, dedicated allocations are mapped on demand.
+		void* Map(const Allocation& allocation);
+		void Unmap(const Allocation& allocation);
+
+		// Moves the allocation to another statistics category.
+		void Rename(Allocation& allocation, const std::string& name);
+
+		uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags propertyFlags) const;
+
+		void PrintStatistics() const;
+
+	private:
+
+		struct Block
+		{
+			VkDeviceMemory Memory{};
+			uint32_t MemoryType{};
+			VkMemoryAllocateFlags AllocateFlags{};
+			bool Linear{};
+			uint32_t Allocations{};
+			void* Mapped{};
+			std::map<VkDeviceSize, VkDeviceSize> FreeRanges; // offset -> size
+		};
+
+		struct Statistics
+		{
+			uint32_t Count{};
+			VkDeviceSize Bytes{};
+		};
+
+		VkDeviceMemory AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, VkMemoryAllocateFlags allocateFlags);
+		void FreeDeviceMemory(VkDeviceMemory memory, VkDeviceSize size);
+		static bool TryAllocate(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+		static void Release(Block& block, VkDeviceSize offset, VkDeviceSize size);
+
+		const class Device& device_;
+
+		VkPhysicalDeviceMemoryProperties memoryProperties_{};
+		VkDeviceSize bufferImageGranularity_{};
+
+		std::vector<std::unique_ptr<Block>> blocks_;
+		std::map<std::string, Statistics> statistics_;
+		uint32_t deviceMemoryCount_{};
+		VkDeviceSize deviceMemoryBytes_{};
+
+		mutable std::mutex mutex_;
+	};
+
+}
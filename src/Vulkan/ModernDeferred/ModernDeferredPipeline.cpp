@@ -9,6 +9,7 @@
 #include "Vulkan/RenderPass.hpp"
 #include "Vulkan/ShaderModule.hpp"
 #include "Vulkan/SwapChain.hpp"
+#include "Assets/Model.hpp"
 #include "Assets/Scene.hpp"
 #include "Assets/UniformBuffer.hpp"
 #include "Assets/Vertex.hpp"
@@ -23,8 +24,12 @@ namespace Vulkan::ModernDeferred
         swapChain_(swapChain)
     {
         const auto& device = swapChain.Device();
-        const auto bindingDescription = Assets::Vertex::GetBindingDescription();
-        const auto attributeDescriptions = Assets::Vertex::GetFastAttributeDescriptions();
+        const auto bindingDescription = scene.CompactVertices()
+            ? Assets::CompactVertex::GetBindingDescription()
+            : Assets::Vertex::GetBindingDescription();
+        const auto attributeDescriptions = scene.CompactVertices()
+            ? Assets::CompactVertex::GetFastAttributeDescriptions()
+            : Assets::Vertex::GetFastAttributeDescriptions();
 
         VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -117,6 +122,7 @@ namespace Vulkan::ModernDeferred
         {
             {0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT},
             {1, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT},
+            {2, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT},
         };
 
         descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
@@ -135,10 +141,16 @@ namespace Vulkan::ModernDeferred
             nodesBufferInfo.buffer = scene.NodeMatrixBuffer().Handle();
             nodesBufferInfo.range = VK_WHOLE_SIZE;
 
+            // Offsets buffer
+            VkDescriptorBufferInfo offsetsBufferInfo = {};
+            offsetsBufferInfo.buffer = scene.OffsetsBuffer().Handle();
+            offsetsBufferInfo.range = VK_WHOLE_SIZE;
+
             const std::vector<VkWriteDescriptorSet> descriptorWrites =
             {
                 descriptorSets.Bind(i, 0, uniformBufferInfo),
                 descriptorSets.Bind(i, 1, nodesBufferInfo),
+                descriptorSets.Bind(i, 2, offsetsBufferInfo),
             };
 
             descriptorSets.UpdateDescriptors(i, descriptorWrites);
@@ -146,11 +158,13 @@ namespace Vulkan::ModernDeferred
 
         // Create pipeline layout and render pass.
         pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
-        renderPass_.reset(new class RenderPass(swapChain, VK_FORMAT_R32_UINT, depthBuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_LOAD_OP_CLEAR));
+        renderPass_.reset(new class RenderPass(swapChain, VK_FORMAT_R32G32_UINT, depthBuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_LOAD_OP_CLEAR));
 
-        // Load shaders.
+        // Load shaders. Flattened geometry gets its triangle index from gl_VertexIndex, only indexed geometry needs gl_PrimitiveID.
         const ShaderModule vertShader(device, "../assets/shaders/VisibilityPass.vert.spv");
-        const ShaderModule fragShader(device, "../assets/shaders/VisibilityPass.frag.spv");
+        const ShaderModule fragShader(device, Assets::Model::ShouldFlattenVertices()
+            ? "../assets/shaders/VisibilityPass.Flattened.frag.spv"
+            : "../assets/shaders/VisibilityPass.frag.spv");
 
         VkPipelineShaderStageCreateInfo shaderStages[] =
         {
@@ -177,7 +191,7 @@ namespace Vulkan::ModernDeferred
         pipelineInfo.renderPass = renderPass_->Handle();
         pipelineInfo.subpass = 0;
 
-        Check(vkCreateGraphicsPipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
+        Check(vkCreateGraphicsPipelines(device.Handle(), device.PipelineCache(), 1, &pipelineInfo, nullptr, &pipeline_),
               "create graphics pipeline");
     }
 
@@ -199,11 +213,12 @@ namespace Vulkan::ModernDeferred
         return descriptorSetManager_->DescriptorSets().Handle(index);
     }
 
-    ShadingPipeline::ShadingPipeline(const SwapChain& swapChain, const ImageView& miniGBufferImageView, const ImageView& finalImageView, const ImageView& motionVectorImageView,
-                                     const std::vector<Assets::UniformBuffer>& uniformBuffers, const Assets::Scene& scene): swapChain_(swapChain)
+    ShadingPipeline::ShadingPipeline(const Device& device, const Assets::Scene& scene, const size_t descriptorSetCount) :
+        device_(device),
+        textureCount_(scene.TextureSamplers().size()),
+        compactVertices_(scene.CompactVertices())
     {
         // Create descriptor pool/sets.
-        const auto& device = swapChain.Device();
         const std::vector<DescriptorBinding> descriptorBindings =
         {
             // MiniGbuffer and output
@@ -224,11 +239,47 @@ namespace Vulkan::ModernDeferred
             {9, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
         };
 
-        descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
+        descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, descriptorSetCount));
+
+        pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
+        const ShaderModule denoiseShader(device, "../assets/shaders/ModernDeferredShading.comp.spv");
+
+        VkComputePipelineCreateInfo pipelineCreateInfo = {};
+        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.stage = denoiseShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT, scene.VertexSpecialization());
+        pipelineCreateInfo.layout = pipelineLayout_->Handle();
+
+        Check(vkCreateComputePipelines(device.Handle(), device.PipelineCache(),
+                                       1, &pipelineCreateInfo,
+                                       NULL, &pipeline_),
+              "create deferred shading pipeline");
+    }
+
+    ShadingPipeline::~ShadingPipeline()
+    {
+        if (pipeline_ != nullptr)
+        {
+            vkDestroyPipeline(device_.Handle(), pipeline_, nullptr);
+            pipeline_ = nullptr;
+        }
+
+        pipelineLayout_.reset();
+        descriptorSetManager_.reset();
+    }
+
+    bool ShadingPipeline::IsCompatible(const Assets::Scene& scene) const
+    {
+        return scene.TextureSamplers().size() == textureCount_ && scene.CompactVertices() == compactVertices_;
+    }
+
+    void ShadingPipeline::UpdateDescriptors(const ImageView& miniGBufferImageView, const ImageView& finalImageView, const ImageView& motionVectorImageView,
+                                            const std::vector<Assets::UniformBuffer>& uniformBuffers, const Assets::Scene& scene)
+    {
+        descriptorSetManager_->Reallocate(uniformBuffers.size());
 
         auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
-        for (uint32_t i = 0; i != swapChain.Images().size(); ++i)
+        for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
         {
             VkDescriptorImageInfo Info0 = {NULL, miniGBufferImageView.Handle(), VK_IMAGE_LAYOUT_GENERAL};
             VkDescriptorImageInfo Info1 = {NULL, finalImageView.Handle(), VK_IMAGE_LAYOUT_GENERAL};
@@ -292,31 +343,6 @@ namespace Vulkan::ModernDeferred
 
             descriptorSets.UpdateDescriptors(i, descriptorWrites);
         }
-
-        pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
-        const ShaderModule denoiseShader(device, "../assets/shaders/ModernDeferredShading.comp.spv");
-
-        VkComputePipelineCreateInfo pipelineCreateInfo = {};
-        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-        pipelineCreateInfo.stage = denoiseShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT);
-        pipelineCreateInfo.layout = pipelineLayout_->Handle();
-
-        Check(vkCreateComputePipelines(device.Handle(), VK_NULL_HANDLE,
-                                       1, &pipelineCreateInfo,
-                                       NULL, &pipeline_),
-              "create deferred shading pipeline");
-    }
-
-    ShadingPipeline::~ShadingPipeline()
-    {
-        if (pipeline_ != nullptr)
-        {
-            vkDestroyPipeline(swapChain_.Device().Handle(), pipeline_, nullptr);
-            pipeline_ = nullptr;
-        }
-
-        pipelineLayout_.reset();
-        descriptorSetManager_.reset();
     }
 
     VkDescriptorSet ShadingPipeline::DescriptorSet(uint32_t index) const
@@ -14,6 +14,7 @@ namespace Assets
 namespace Vulkan
 {
 	class DepthBuffer;
+	class Device;
 	class PipelineLayout;
 	class RenderPass;
 	class SwapChain;
@@ -56,17 +57,23 @@ namespace Vulkan::ModernDeferred
 	public:
 		VULKAN_NON_COPIABLE(ShadingPipeline)
 	
-		ShadingPipeline(
-			const SwapChain& swapChain, 
+		ShadingPipeline(const Device& device, const Assets::Scene& scene, size_t descriptorSetCount);
+		~ShadingPipeline();
+
+		// The layout depends on the texture count and the shader on the vertex layout.
+		bool IsCompatible(const Assets::Scene& scene) const;
+
+		void UpdateDescriptors(
 			const ImageView& miniGBufferImageView, const ImageView& finalImageView, const ImageView& motionVectorImageView,
 			const std::vector<Assets::UniformBuffer>& uniformBuffers,
 			const Assets::Scene& scene);
-		~ShadingPipeline();
 
 		VkDescriptorSet DescriptorSet(uint32_t index) const;
 		const Vulkan::PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 	private:
-		const SwapChain& swapChain_;
+		const Device& device_;
+		const size_t textureCount_;
+		const bool compactVertices_;
 		
 		VULKAN_HANDLE(VkPipeline, pipeline_)
 
@@ -4,6 +4,7 @@
 #include "Vulkan/Buffer.hpp"
 #include "Vulkan/Device.hpp"
 #include "Vulkan/FrameBuffer.hpp"
+#include "Vulkan/GpuProfiler.hpp"
 #include "Vulkan/PipelineLayout.hpp"
 #include "Vulkan/RenderPass.hpp"
 #include "Vulkan/SwapChain.hpp"
@@ -13,8 +14,10 @@
 #include "Assets/Model.hpp"
 #include "Assets/Scene.hpp"
 #include "Assets/UniformBuffer.hpp"
+#include "Utilities/Console.hpp"
 #include "Utilities/Exception.hpp"
 #include <array>
+#include <iostream>
 
 namespace Vulkan::ModernDeferred {
 
@@ -27,6 +30,32 @@ ModernDeferredRenderer::ModernDeferredRenderer(const WindowConfig& windowConfig,
 ModernDeferredRenderer::~ModernDeferredRenderer()
 {
 	ModernDeferredRenderer::DeleteSwapChain();
+	deferredShadingPipeline_.reset();
+	accumulatePipeline_.reset();
+}
+
+void ModernDeferredRenderer::SetPhysicalDeviceImpl(
+	VkPhysicalDevice physicalDevice,
+	std::vector<const char*>& requiredExtensions,
+	VkPhysicalDeviceFeatures& deviceFeatures,
+	void* nextDeviceFeatures)
+{
+	// The visibility pass reads gl_PrimitiveID for indexed geometry, without geometryShader it falls back to
+	// flattened geometry. The scene is loaded after the device is set, so this still applies to it.
+	if (!deviceFeatures.geometryShader && !Assets::Model::ShouldFlattenVertices())
+	{
+		Utilities::Console::Write(Utilities::Severity::Warning, [&]()
+		{
+			std::cout << "WARNING: geometryShader is not supported, the modern deferred renderer flattens all geometry" << std::endl;
+		});
+		Assets::Model::RequireFlattenedVertices();
+	}
+	if (!deviceFeatures.shaderStorageImageExtendedFormats)
+	{
+		Throw(std::runtime_error("the modern deferred renderer requires shaderStorageImageExtendedFormats, use --renderer=2 instead"));
+	}
+
+	Vulkan::VulkanBaseRenderer::SetPhysicalDeviceImpl(physicalDevice, requiredExtensions, deviceFeatures, nextDeviceFeatures);
 }
 
 void ModernDeferredRenderer::CreateSwapChain()
@@ -39,21 +68,21 @@ void ModernDeferredRenderer::CreateSwapChain()
 	visibilityPipeline_.reset(new VisibilityPipeline(SwapChain(), DepthBuffer(), UniformBuffers(), GetScene()));
 	
 	visibilityBufferImage_.reset(new Image(Device(), extent,
-		VK_FORMAT_R32_UINT, VK_IMAGE_TILING_OPTIMAL,
+		VK_FORMAT_R32G32_UINT, VK_IMAGE_TILING_OPTIMAL,
 		VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT));
 	visibilityBufferImageMemory_.reset(
 		new DeviceMemory(visibilityBufferImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 	visibilityBufferImageView_.reset(new ImageView(Device(), visibilityBufferImage_->Handle(),
-		VK_FORMAT_R32_UINT,
+		VK_FORMAT_R32G32_UINT,
 		VK_IMAGE_ASPECT_COLOR_BIT));
 
 	visibilityBuffer1Image_.reset(new Image(Device(), extent,
-	VK_FORMAT_R32_UINT, VK_IMAGE_TILING_OPTIMAL,
+	VK_FORMAT_R32G32_UINT, VK_IMAGE_TILING_OPTIMAL,
 	VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT));
 	visibilityBuffer1ImageMemory_.reset(
 		new DeviceMemory(visibilityBuffer1Image_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 	visibilityBuffer1ImageView_.reset(new ImageView(Device(), visibilityBuffer1Image_->Handle(),
-		VK_FORMAT_R32_UINT,
+		VK_FORMAT_R32G32_UINT,
 		VK_IMAGE_ASPECT_COLOR_BIT));
 
 	validateImage_.reset(new Image(Device(), extent,
@@ -103,23 +132,42 @@ VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT));
 	
 	
 	deferredFrameBuffer_.reset(new FrameBuffer(*visibilityBufferImageView_, visibilityPipeline_->RenderPass()));
-	deferredShadingPipeline_.reset(new ShadingPipeline(SwapChain(), *visibilityBufferImageView_, *outputImageView_, *motionVectorImageView_, UniformBuffers(), GetScene()));
-	accumulatePipeline_.reset(new PipelineCommon::AccumulatePipeline(SwapChain(), *outputImageView_, *accumulateImageView_, *accumulateImage1View_, *motionVectorImageView_,
+
+	// The compute pipelines outlive the swap chain, only their descriptors follow the new images. The shading
+	// one is rebuilt when a new scene changes its layout.
+	if (!deferredShadingPipeline_ || !deferredShadingPipeline_->IsCompatible(GetScene()))
+	{
+		deferredShadingPipeline_.reset(new ShadingPipeline(Device(), GetScene(), UniformBuffers().size()));
+	}
+
+	if (!accumulatePipeline_)
+	{
+		accumulatePipeline_.reset(new PipelineCommon::AccumulatePipeline(Device(), UniformBuffers().size()));
+	}
+
+	deferredShadingPipeline_->UpdateDescriptors(*visibilityBufferImageView_, *outputImageView_, *motionVectorImageView_, UniformBuffers(), GetScene());
+	accumulatePipeline_->UpdateDescriptors(*outputImageView_, *accumulateImageView_, *accumulateImage1View_, *motionVectorImageView_,
 	*visibilityBufferImageView_,*visibilityBuffer1ImageView_, *validateImageView_,
-	UniformBuffers(), GetScene()));
+	UniformBuffers());
 
 	const auto& debugUtils = Device().DebugUtils();
 	debugUtils.SetObjectName(outputImage_->Handle(), "Output Image");
 	debugUtils.SetObjectName(visibilityBufferImage_->Handle(), "Visibility Image");
 	debugUtils.SetObjectName(visibilityBuffer1Image_->Handle(), "Visibility1 Image");
 	debugUtils.SetObjectName(accumulateImage_->Handle(), "Accumulate Image");
+
+	outputImageMemory_->SetName("Output Image");
+	visibilityBufferImageMemory_->SetName("Visibility Image");
+	visibilityBuffer1ImageMemory_->SetName("Visibility1 Image");
+	validateImageMemory_->SetName("Validate Image");
+	accumulateImageMemory_->SetName("Accumulate Image");
+	accumulateImage1Memory_->SetName("Accumulate Image");
+	motionVectorImageMemory_->SetName("Motion Vector Image");
 }
 
 void ModernDeferredRenderer::DeleteSwapChain()
 {
 	visibilityPipeline_.reset();
-	deferredShadingPipeline_.reset();
-	accumulatePipeline_.reset();
 	
 	deferredFrameBuffer_.reset();
 
@@ -170,6 +218,7 @@ void ModernDeferredRenderer::Render(VkCommandBuffer commandBuffer, uint32_t imag
 	renderPassInfo.pClearValues = clearValues.data();
 
 	// make it to generate gbuffer
+	GpuProfiler().BeginZone(commandBuffer, "Visibility");
 	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 	{
 		const auto& scene = GetScene();
@@ -204,6 +253,7 @@ void ModernDeferredRenderer::Render(VkCommandBuffer commandBuffer, uint32_t imag
 		}
 	}
 	vkCmdEndRenderPass(commandBuffer);
+	GpuProfiler().EndZone(commandBuffer);
 
 	VkImageSubresourceRange subresourceRange = {};
 	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -233,11 +283,13 @@ void ModernDeferredRenderer::Render(VkCommandBuffer commandBuffer, uint32_t imag
 	
 	// cs shading pass
 	{
+		GpuProfiler().BeginZone(commandBuffer, "Shading");
 		VkDescriptorSet DescriptorSets[] = {deferredShadingPipeline_->DescriptorSet(imageIndex)};
 		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, deferredShadingPipeline_->Handle());
 		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
 								deferredShadingPipeline_->PipelineLayout().Handle(), 0, 1, DescriptorSets, 0, nullptr);
 		vkCmdDispatch(commandBuffer, SwapChain().Extent().width / 8 / ( CheckerboxRendering() ? 2 : 1 ), SwapChain().Extent().height / 4, 1);	
+		GpuProfiler().EndZone(commandBuffer);
 	}
 
 	ImageMemoryBarrier::Insert(commandBuffer, motionVectorImage_->Handle(), subresourceRange,
@@ -247,14 +299,17 @@ void ModernDeferredRenderer::Render(VkCommandBuffer commandBuffer, uint32_t imag
 	// cs shading pass
 	// ping pong
 	{
+		GpuProfiler().BeginZone(commandBuffer, "Accumulate");
 		VkDescriptorSet DescriptorSets[] = {accumulatePipeline_->DescriptorSet(imageIndex)};
 		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, accumulatePipeline_->Handle());
 		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
 								accumulatePipeline_->PipelineLayout().Handle(), 0, 1, DescriptorSets, 0, nullptr);
 		vkCmdDispatch(commandBuffer, SwapChain().Extent().width / 8, SwapChain().Extent().height / 4, 1);
+		GpuProfiler().EndZone(commandBuffer);
 	}
 	
 	// copy to swap-buffer
+	GpuProfiler().BeginZone(commandBuffer, "Copy");
 	VkImage srcAccumulateImage = frameCount_ % 2 == 0 ? accumulateImage1_->Handle() : accumulateImage_->Handle();
 	
 	ImageMemoryBarrier::Insert(commandBuffer, srcAccumulateImage, subresourceRange,
@@ -281,5 +336,6 @@ void ModernDeferredRenderer::Render(VkCommandBuffer commandBuffer, uint32_t imag
 	ImageMemoryBarrier::Insert(commandBuffer, SwapChain().Images()[imageIndex], subresourceRange,
 							   VK_ACCESS_TRANSFER_WRITE_BIT,
 							   0, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	GpuProfiler().EndZone(commandBuffer);
 }
 }
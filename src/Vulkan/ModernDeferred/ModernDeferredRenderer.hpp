@@ -35,6 +35,13 @@ namespace Vulkan::ModernDeferred
 		void DeleteSwapChain() override;
 		void Render(VkCommandBuffer commandBuffer, uint32_t imageIndex) override;
 
+	protected:
+
+		void SetPhysicalDeviceImpl(VkPhysicalDevice physicalDevice,
+			std::vector<const char*>& requiredExtensions,
+			VkPhysicalDeviceFeatures& deviceFeatures,
+			void* nextDeviceFeatures) override;
+
 	private:
 		std::unique_ptr<class VisibilityPipeline> visibilityPipeline_;
 		std::unique_ptr<class ShadingPipeline> deferredShadingPipeline_;
@@ -0,0 +1,136 @@
+#include "PipelineCache.hpp"
+#include "Device.hpp"
+#include "Utilities/AtomicFile.hpp"
+#include "Utilities/Console.hpp"
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace Vulkan {
+
+namespace
+{
+	const uint32_t CacheMagic = 0x43504B47; // 'GKPC'
+
+	struct CacheHeader
+	{
+		uint32_t Magic;
+		uint32_t VendorID;
+		uint32_t DeviceID;
+		uint32_t DriverVersion;
+		uint8_t DeviceUUID[VK_UUID_SIZE];
+		uint64_t DataSize;
+	};
+
+	CacheHeader MakeHeader(const VkPhysicalDeviceProperties& properties, const uint64_t dataSize)
+	{
+		CacheHeader header{};
+		header.Magic = CacheMagic;
+		header.VendorID = properties.vendorID;
+		header.DeviceID = properties.deviceID;
+		header.DriverVersion = properties.driverVersion;
+		std::memcpy(header.DeviceUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+		header.DataSize = dataSize;
+		return header;
+	}
+}
+
+PipelineCache::PipelineCache(const class Device& device, std::string filename) :
+	device_(device),
+	filename_(std::move(filename))
+{
+	vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties_);
+
+	// Anything unreadable or stale is simply dropped, the driver rebuilds the pipelines from scratch.
+	std::vector<char> data;
+	std::ifstream in(filename_, std::ios::binary);
+	CacheHeader header{};
+	const CacheHeader expected = MakeHeader(properties_, 0);
+
+	if (in && in.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+		header.Magic == expected.Magic &&
+		header.VendorID == expected.VendorID &&
+		header.DeviceID == expected.DeviceID &&
+		header.DriverVersion == expected.DriverVersion &&
+		std::memcmp(header.DeviceUUID, expected.DeviceUUID, VK_UUID_SIZE) == 0)
+	{
+		// The size comes from disk, a corrupt header must not size the allocation. The blob runs to the end of the file.
+		const auto dataStart = in.tellg();
+		in.seekg(0, std::ios::end);
+		const auto remaining = static_cast<uint64_t>(in.tellg() - dataStart);
+		in.seekg(dataStart);
+
+		if (header.DataSize == remaining)
+		{
+			data.resize(static_cast<size_t>(header.DataSize));
+			if (!in.read(data.data(), data.size()))
+			{
+				data.clear();
+			}
+		}
+	}
+
+	VkPipelineCacheCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = data.size();
+	createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+	Check(vkCreatePipelineCache(device.Handle(), &createInfo, nullptr, &pipelineCache_),
+		"create pipeline cache");
+
+	std::cout << "- pipeline cache: " << (data.empty() ? "cold" : "loaded") << " (" << data.size() / 1024 << " KB)" << std::endl;
+}
+
+PipelineCache::~PipelineCache()
+{
+	if (pipelineCache_ != nullptr)
+	{
+		vkDestroyPipelineCache(device_.Handle(), pipelineCache_, nullptr);
+		pipelineCache_ = nullptr;
+	}
+}
+
+void PipelineCache::Save() const
+{
+	// Runs from the renderer destructor, losing the cache is not worth an exception there.
+	size_t size = 0;
+	std::vector<char> data;
+	try
+	{
+		Check(vkGetPipelineCacheData(device_.Handle(), pipelineCache_, &size, nullptr),
+			"get pipeline cache data size");
+
+		data.resize(size);
+		Check(vkGetPipelineCacheData(device_.Handle(), pipelineCache_, &size, data.data()),
+			"get pipeline cache data");
+	}
+	catch (const std::exception& exception)
+	{
+		Utilities::Console::Write(Utilities::Severity::Warning, [&exception]()
+		{
+			std::cout << "WARNING: failed to save pipeline cache (" << exception.what() << ")" << std::endl;
+		});
+		return;
+	}
+
+	const CacheHeader header = MakeHeader(properties_, size);
+
+	const bool written = Utilities::AtomicFile::Write(filename_, std::ios::binary, [&](std::ofstream& out)
+	{
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(data.data(), size);
+	});
+
+	if (!written)
+	{
+		Utilities::Console::Write(Utilities::Severity::Warning, [this]()
+		{
+			std::cout << "WARNING: failed to write pipeline cache '" << filename_ << "'" << std::endl;
+		});
+	}
+}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include <string>
+
+namespace Vulkan
+{
+	class Device;
+
+	// A device-wide pipeline cache backed by a file. The file carries the device UUID and driver version,
+	// a blob written by another GPU or driver is ignored and the cache starts out empty.
+	class PipelineCache final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(PipelineCache)
+
+		PipelineCache(const Device& device, std::string filename);
+		~PipelineCache();
+
+		const class Device& Device() const { return device_; }
+
+		void Save() const;
+
+	private:
+
+		const class Device& device_;
+		const std::string filename_;
+
+		VkPhysicalDeviceProperties properties_{};
+
+		VULKAN_HANDLE(VkPipelineCache, pipelineCache_)
+	};
+
+}
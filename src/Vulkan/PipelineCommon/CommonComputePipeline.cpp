@@ -6,24 +6,13 @@
 #include "Vulkan/Device.hpp"
 #include "Vulkan/PipelineLayout.hpp"
 #include "Vulkan/ShaderModule.hpp"
-#include "Vulkan/SwapChain.hpp"
-#include "Assets/Scene.hpp"
 #include "Assets/UniformBuffer.hpp"
-#include "Assets/Vertex.hpp"
 
 namespace Vulkan::PipelineCommon
 {
-    AccumulatePipeline::AccumulatePipeline(const SwapChain& swapChain, const ImageView& sourceImageView,
-                                           const ImageView& accumulateImageView, const ImageView& accumulateImage1View,
-                                           const ImageView& motionVectorImageView,
-                                           const ImageView& visibilityBufferImageView,
-                                           const ImageView& prevVisibilityBufferImageView,
-                                           const ImageView& validateImage1View,
-                                           const std::vector<Assets::UniformBuffer>& uniformBuffers,
-                                           const Assets::Scene& scene): swapChain_(swapChain)
+    AccumulatePipeline::AccumulatePipeline(const Device& device, const size_t descriptorSetCount): device_(device)
     {
         // Create descriptor pool/sets.
-        const auto& device = swapChain.Device();
         const std::vector<DescriptorBinding> descriptorBindings =
         {
             {0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
@@ -36,11 +25,47 @@ namespace Vulkan::PipelineCommon
             {7, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
         };
 
-        descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
+        descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, descriptorSetCount));
+
+        pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
+        const ShaderModule denoiseShader(device, "../assets/shaders/Accumulate.comp.spv");
+
+        VkComputePipelineCreateInfo pipelineCreateInfo = {};
+        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.stage = denoiseShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT);
+        pipelineCreateInfo.layout = pipelineLayout_->Handle();
+
+        Check(vkCreateComputePipelines(device.Handle(), device.PipelineCache(),
+                                       1, &pipelineCreateInfo,
+                                       NULL, &pipeline_),
+              "create deferred shading pipeline");
+    }
+
+    AccumulatePipeline::~AccumulatePipeline()
+    {
+        if (pipeline_ != nullptr)
+        {
+            vkDestroyPipeline(device_.Handle(), pipeline_, nullptr);
+            pipeline_ = nullptr;
+        }
+
+        pipelineLayout_.reset();
+        descriptorSetManager_.reset();
+    }
+
+    void AccumulatePipeline::UpdateDescriptors(const ImageView& sourceImageView,
+                                               const ImageView& accumulateImageView, const ImageView& accumulateImage1View,
+                                               const ImageView& motionVectorImageView,
+                                               const ImageView& visibilityBufferImageView,
+                                               const ImageView& prevVisibilityBufferImageView,
+                                               const ImageView& validateImage1View,
+                                               const std::vector<Assets::UniformBuffer>& uniformBuffers)
+    {
+        descriptorSetManager_->Reallocate(uniformBuffers.size());
 
         auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
-        for (uint32_t i = 0; i != swapChain.Images().size(); ++i)
+        for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
         {
             VkDescriptorImageInfo Info0 = {NULL, sourceImageView.Handle(), VK_IMAGE_LAYOUT_GENERAL};
             VkDescriptorImageInfo Info1 = {NULL, accumulateImageView.Handle(), VK_IMAGE_LAYOUT_GENERAL};
@@ -68,31 +93,6 @@ namespace Vulkan::PipelineCommon
 
             descriptorSets.UpdateDescriptors(i, descriptorWrites);
         }
-
-        pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
-        const ShaderModule denoiseShader(device, "../assets/shaders/Accumulate.comp.spv");
-
-        VkComputePipelineCreateInfo pipelineCreateInfo = {};
-        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-        pipelineCreateInfo.stage = denoiseShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT);
-        pipelineCreateInfo.layout = pipelineLayout_->Handle();
-
-        Check(vkCreateComputePipelines(device.Handle(), VK_NULL_HANDLE,
-                                       1, &pipelineCreateInfo,
-                                       NULL, &pipeline_),
-              "create deferred shading pipeline");
-    }
-
-    AccumulatePipeline::~AccumulatePipeline()
-    {
-        if (pipeline_ != nullptr)
-        {
-            vkDestroyPipeline(swapChain_.Device().Handle(), pipeline_, nullptr);
-            pipeline_ = nullptr;
-        }
-
-        pipelineLayout_.reset();
-        descriptorSetManager_.reset();
     }
 
     VkDescriptorSet AccumulatePipeline::DescriptorSet(uint32_t index) const
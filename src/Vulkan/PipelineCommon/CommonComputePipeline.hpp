@@ -7,16 +7,13 @@
 
 namespace Assets
 {
-	class Scene;
 	class UniformBuffer;
 }
 
 namespace Vulkan
 {
-	class DepthBuffer;
+	class Device;
 	class PipelineLayout;
-	class RenderPass;
-	class SwapChain;
 	class DescriptorSetManager;
 }
 
@@ -27,19 +24,19 @@ namespace Vulkan::PipelineCommon
 	public:
 		VULKAN_NON_COPIABLE(AccumulatePipeline)
 	
-		AccumulatePipeline(
-			const SwapChain& swapChain, 
+		AccumulatePipeline(const Device& device, size_t descriptorSetCount);
+		~AccumulatePipeline();
+
+		void UpdateDescriptors(
 			const ImageView& sourceImageView, const ImageView& accumulateImageView, const ImageView& motionVectorImageView, const ImageView& motionVectorImage1View,
 			const ImageView& visibilityBufferImageView,const ImageView& prevVisibilityBufferImageView,
 			const ImageView& validateImage1View,
-			const std::vector<Assets::UniformBuffer>& uniformBuffers,
-			const Assets::Scene& scene);
-		~AccumulatePipeline();
+			const std::vector<Assets::UniformBuffer>& uniformBuffers);
 
 		VkDescriptorSet DescriptorSet(uint32_t index) const;
 		const Vulkan::PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 	private:
-		const SwapChain& swapChain_;
+		const Device& device_;
 		
 		VULKAN_HANDLE(VkPipeline, pipeline_)
 
@@ -0,0 +1,68 @@
+#include "QueryPool.hpp"
+#include "Device.hpp"
+
+namespace Vulkan {
+
+QueryPool::QueryPool(const class Device& device, const VkQueryType type, const uint32_t queryCount) :
+	device_(device),
+	queryCount_(queryCount)
+{
+	VkQueryPoolCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	createInfo.queryType = type;
+	createInfo.queryCount = queryCount;
+
+	Check(vkCreateQueryPool(device.Handle(), &createInfo, nullptr, &queryPool_),
+		"create query pool");
+}
+
+QueryPool::~QueryPool()
+{
+	if (queryPool_ != nullptr)
+	{
+		vkDestroyQueryPool(device_.Handle(), queryPool_, nullptr);
+		queryPool_ = nullptr;
+	}
+}
+
+void QueryPool::Reset(VkCommandBuffer commandBuffer) const
+{
+	vkCmdResetQueryPool(commandBuffer, queryPool_, 0, queryCount_);
+}
+
+std::vector<uint64_t> QueryPool::GetResults(const uint32_t count) const
+{
+	std::vector<uint64_t> results(count);
+
+	if (count != 0)
+	{
+		Check(vkGetQueryPoolResults(device_.Handle(), queryPool_, 0, count, results.size() * sizeof(uint64_t), results.data(),
+			sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT),
+			"get query pool results");
+	}
+
+	return results;
+}
+
+bool QueryPool::TryGetResults(const uint32_t count, std::vector<uint64_t>& results) const
+{
+	results.resize(count);
+
+	if (count == 0)
+	{
+		return true;
+	}
+
+	const auto result = vkGetQueryPoolResults(device_.Handle(), queryPool_, 0, count, results.size() * sizeof(uint64_t), results.data(),
+		sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+	if (result == VK_NOT_READY)
+	{
+		return false;
+	}
+
+	Check(result, "get query pool results");
+	return true;
+}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include <vector>
+
+namespace Vulkan
+{
+	class Device;
+
+	class QueryPool final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(QueryPool)
+
+		QueryPool(const Device& device, VkQueryType type, uint32_t queryCount);
+		~QueryPool();
+
+		const class Device& Device() const { return device_; }
+		uint32_t QueryCount() const { return queryCount_; }
+
+		void Reset(VkCommandBuffer commandBuffer) const;
+
+		// Blocks until the first `count` queries are available.
+		std::vector<uint64_t> GetResults(uint32_t count) const;
+
+		// Returns false instead of waiting when any of the first `count` queries is not available yet.
+		bool TryGetResults(uint32_t count, std::vector<uint64_t>& results) const;
+
+	private:
+
+		const class Device& device_;
+		const uint32_t queryCount_;
+
+		VULKAN_HANDLE(VkQueryPool, queryPool_)
+	};
+
+}
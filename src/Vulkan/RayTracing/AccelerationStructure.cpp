@@ -17,9 +17,10 @@ namespace
 	}
 }
 
-AccelerationStructure::AccelerationStructure(const class DeviceProcedures& deviceProcedures, const RayTracingProperties& rayTracingProperties) :
+AccelerationStructure::AccelerationStructure(const class DeviceProcedures& deviceProcedures, const RayTracingProperties& rayTracingProperties,
+	const VkBuildAccelerationStructureFlagsKHR flags) :
 	deviceProcedures_(deviceProcedures),
-	flags_(VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR),
+	flags_(flags),
 	device_(deviceProcedures.Device()),
 	rayTracingProperties_(rayTracingProperties)
 {
@@ -32,13 +33,17 @@ AccelerationStructure::AccelerationStructure(AccelerationStructure&& other) noex
 	buildSizesInfo_(other.buildSizesInfo_),
 	device_(other.device_),
 	rayTracingProperties_(other.rayTracingProperties_),
+	compactionSource_(other.compactionSource_),
 	accelerationStructure_(other.accelerationStructure_)
 {
+	other.compactionSource_ = nullptr;
 	other.accelerationStructure_ = nullptr;
 }
 
 AccelerationStructure::~AccelerationStructure()
 {
+	ReleaseCompactionSource();
+
 	if (accelerationStructure_ != nullptr)
 	{
 		deviceProcedures_.vkDestroyAccelerationStructureKHR(device_.Handle(), accelerationStructure_, nullptr);
@@ -83,6 +88,34 @@ void AccelerationStructure::CreateAccelerationStructure(Buffer& resultBuffer, co
 		"create acceleration structure");
 }
 
+void AccelerationStructure::Compact(VkCommandBuffer commandBuffer, const VkDeviceSize compactedSize, Buffer& resultBuffer, const VkDeviceSize resultOffset)
+{
+	ReleaseCompactionSource();
+
+	compactionSource_ = accelerationStructure_;
+	accelerationStructure_ = nullptr;
+	buildSizesInfo_.accelerationStructureSize = compactedSize;
+
+	CreateAccelerationStructure(resultBuffer, resultOffset);
+
+	VkCopyAccelerationStructureInfoKHR copyInfo = {};
+	copyInfo.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR;
+	copyInfo.src = compactionSource_;
+	copyInfo.dst = accelerationStructure_;
+	copyInfo.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
+
+	deviceProcedures_.vkCmdCopyAccelerationStructureKHR(commandBuffer, &copyInfo);
+}
+
+void AccelerationStructure::ReleaseCompactionSource()
+{
+	if (compactionSource_ != nullptr)
+	{
+		deviceProcedures_.vkDestroyAccelerationStructureKHR(device_.Handle(), compactionSource_, nullptr);
+		compactionSource_ = nullptr;
+	}
+}
+
 void AccelerationStructure::MemoryBarrier(VkCommandBuffer commandBuffer)
 {
 	// Wait for the builder to complete by setting a barrier on the resulting buffer. This is
@@ -29,10 +29,17 @@ namespace Vulkan::RayTracing
 		const VkAccelerationStructureBuildSizesInfoKHR BuildSizes() const { return buildSizesInfo_; }
 
 		static void MemoryBarrier(VkCommandBuffer commandBuffer);
+
+		// Records a compacting copy into `resultBuffer`, the structure refers to the copy from then on.
+		// Needs ALLOW_COMPACTION at build time. The uncompacted original stays alive until ReleaseCompactionSource(),
+		// call it once the copy has executed.
+		void Compact(VkCommandBuffer commandBuffer, VkDeviceSize compactedSize, Buffer& resultBuffer, VkDeviceSize resultOffset);
+		void ReleaseCompactionSource();
 	
 	protected:
 
-		explicit AccelerationStructure(const class DeviceProcedures& deviceProcedures, const class RayTracingProperties& rayTracingProperties);
+		explicit AccelerationStructure(const class DeviceProcedures& deviceProcedures, const class RayTracingProperties& rayTracingProperties,
+			VkBuildAccelerationStructureFlagsKHR flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR);
 
 		VkAccelerationStructureBuildSizesInfoKHR GetBuildSizes(const uint32_t* pMaxPrimitiveCounts) const;
 		void CreateAccelerationStructure(Buffer& resultBuffer, VkDeviceSize resultOffset);
@@ -47,6 +54,8 @@ namespace Vulkan::RayTracing
 
 		const class Device& device_;
 		const class RayTracingProperties& rayTracingProperties_;
+
+		VkAccelerationStructureKHR compactionSource_{};
 		
 		VULKAN_HANDLE(VkAccelerationStructureKHR, accelerationStructure_)
 	};
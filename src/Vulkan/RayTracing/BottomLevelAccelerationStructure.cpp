@@ -10,8 +10,10 @@ namespace Vulkan::RayTracing {
 BottomLevelAccelerationStructure::BottomLevelAccelerationStructure(
 	const class DeviceProcedures& deviceProcedures,
 	const class RayTracingProperties& rayTracingProperties,
-	const BottomLevelGeometry& geometries) :
-	AccelerationStructure(deviceProcedures, rayTracingProperties),
+	const BottomLevelGeometry& geometries,
+	const bool allowCompaction) :
+	AccelerationStructure(deviceProcedures, rayTracingProperties,
+		VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | (allowCompaction ? VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR : 0)),
 	geometries_(geometries)
 {
 	buildGeometryInfo_.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
@@ -49,16 +51,25 @@ void BottomLevelAccelerationStructure::Generate(
 	Buffer& resultBuffer,
 	const VkDeviceSize resultOffset)
 {
-	// Create the acceleration structure.
-	CreateAccelerationStructure(resultBuffer, resultOffset);
+	PrepareBuild(scratchBuffer, scratchOffset, resultBuffer, resultOffset);
 
 	// Build the actual bottom-level acceleration structure
-	const VkAccelerationStructureBuildRangeInfoKHR* pBuildOffsetInfo = geometries_.BuildOffsetInfo().data();
+	const VkAccelerationStructureBuildRangeInfoKHR* pBuildOffsetInfo = BuildRangeInfo();
+
+	deviceProcedures_.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &buildGeometryInfo_, &pBuildOffsetInfo);
+}
+
+void BottomLevelAccelerationStructure::PrepareBuild(
+	Buffer& scratchBuffer,
+	const VkDeviceSize scratchOffset,
+	Buffer& resultBuffer,
+	const VkDeviceSize resultOffset)
+{
+	// Create the acceleration structure.
+	CreateAccelerationStructure(resultBuffer, resultOffset);
 
 	buildGeometryInfo_.dstAccelerationStructure = Handle();
 	buildGeometryInfo_.scratchData.deviceAddress = scratchBuffer.GetDeviceAddress() + scratchOffset;
-
-	deviceProcedures_.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &buildGeometryInfo_, &pBuildOffsetInfo);
 }
 
 }
@@ -23,7 +23,8 @@ namespace Vulkan::RayTracing
 		BottomLevelAccelerationStructure(
 			const class DeviceProcedures& deviceProcedures, 
 			const class RayTracingProperties& rayTracingProperties, 
-			const BottomLevelGeometry& geometries);
+			const BottomLevelGeometry& geometries,
+			bool allowCompaction = false);
 		BottomLevelAccelerationStructure(BottomLevelAccelerationStructure&& other) noexcept;
 		~BottomLevelAccelerationStructure();
 
@@ -34,6 +35,17 @@ namespace Vulkan::RayTracing
 			Buffer& resultBuffer,
 			VkDeviceSize resultOffset);
 
+		// Creates the structure and fills in its build info without recording the build, so that
+		// several structures can be built with a single vkCmdBuildAccelerationStructuresKHR call.
+		void PrepareBuild(
+			Buffer& scratchBuffer,
+			VkDeviceSize scratchOffset,
+			Buffer& resultBuffer,
+			VkDeviceSize resultOffset);
+
+		const VkAccelerationStructureBuildGeometryInfoKHR& BuildGeometryInfo() const { return buildGeometryInfo_; }
+		const VkAccelerationStructureBuildRangeInfoKHR* BuildRangeInfo() const { return geometries_.BuildOffsetInfo().data(); }
+
 	private:
 
 		BottomLevelGeometry geometries_;
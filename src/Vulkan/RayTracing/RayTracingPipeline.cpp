@@ -12,32 +12,29 @@
 #include "Vulkan/ImageView.hpp"
 #include "Vulkan/PipelineLayout.hpp"
 #include "Vulkan/ShaderModule.hpp"
-#include "Vulkan/SwapChain.hpp"
 
 namespace Vulkan::RayTracing
 {
     RayTracingPipeline::RayTracingPipeline(
         const DeviceProcedures& deviceProcedures,
-        const SwapChain& swapChain,
-        const TopLevelAccelerationStructure& accelerationStructure,
-        const ImageView& accumulationImageView,
-        const ImageView& motionVectorImageView,
-        const ImageView& gbufferImageView,
-        const ImageView& albedoImageView,
-        const ImageView& visibilityBufferImageView,
-        const ImageView& visibility1BufferImageView,
-        const std::vector<Assets::UniformBuffer>& uniformBuffers,
-        const Assets::Scene& scene) :
-        swapChain_(swapChain)
+        const Device& device,
+        const Assets::Scene& scene,
+        const uint32_t maxBounces,
+        const size_t descriptorSetCount) :
+        device_(device),
+        textureCount_(scene.TextureSamplers().size()),
+        compactVertices_(scene.CompactVertices()),
+        maxBounces_(maxBounces)
     {
         // Create descriptor pool/sets.
-        const auto& device = swapChain.Device();
         const std::vector<DescriptorBinding> descriptorBindings =
         {
             // Top level acceleration structure.
             {0, 1, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
             // Light buffer
             {1, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+            // Node buffer, indexed by the custom index of triangle instances
+            {2, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
             // Camera information & co
             {
                 3, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
@@ -56,7 +53,7 @@ namespace Vulkan::RayTracing
                 VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR
             },
 
-            // The Procedural buffer.
+            // The Procedural buffer, one world space primitive per procedural node.
             {
                 9, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                 VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR
@@ -69,13 +66,148 @@ namespace Vulkan::RayTracing
             {13, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
             {14, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
             {15, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+
+            // Light alias table, picks the light to sample proportionally to its power
+            {16, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+
+            // Sky alias table, picks diffuse bounce directions towards the bright parts of the HDR sky
+            {17, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+        };
+
+        descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, descriptorSetCount));
+
+        rayTracePipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
+
+        // Load shaders.
+        const ShaderModule rayGenShader(device, "../assets/shaders/RayTracing.rgen.spv");
+        const ShaderModule missShader(device, "../assets/shaders/RayTracing.rmiss.spv");
+        const ShaderModule closestHitShader(device, "../assets/shaders/RayTracing.rchit.spv");
+        const ShaderModule proceduralClosestHitShader(device, "../assets/shaders/RayTracing.Procedural.rchit.spv");
+        const ShaderModule proceduralIntersectionShader(device, "../assets/shaders/RayTracing.Procedural.rint.spv");
+
+        // MaxBounces (constant_id 1) bounds the path loop of the ray generation shader.
+        VkSpecializationMapEntry bouncesEntry = {};
+        bouncesEntry.constantID = 1;
+        bouncesEntry.offset = 0;
+        bouncesEntry.size = sizeof(uint32_t);
+
+        VkSpecializationInfo bouncesSpecialization = {};
+        bouncesSpecialization.mapEntryCount = 1;
+        bouncesSpecialization.pMapEntries = &bouncesEntry;
+        bouncesSpecialization.dataSize = sizeof(uint32_t);
+        bouncesSpecialization.pData = &maxBounces_;
+
+        std::vector<VkPipelineShaderStageCreateInfo> shaderStages =
+        {
+            rayGenShader.CreateShaderStage(VK_SHADER_STAGE_RAYGEN_BIT_KHR, &bouncesSpecialization),
+            missShader.CreateShaderStage(VK_SHADER_STAGE_MISS_BIT_KHR),
+            closestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, scene.VertexSpecialization()),
+            proceduralClosestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, scene.VertexSpecialization()),
+            proceduralIntersectionShader.CreateShaderStage(VK_SHADER_STAGE_INTERSECTION_BIT_KHR),
+        };
+
+        // Shader groups
+        VkRayTracingShaderGroupCreateInfoKHR rayGenGroupInfo = {};
+        rayGenGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
+        rayGenGroupInfo.pNext = nullptr;
+        rayGenGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
+        rayGenGroupInfo.generalShader = 0;
+        rayGenGroupInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
+        rayGenGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
+        rayGenGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
+        rayGenIndex_ = 0;
+
+        VkRayTracingShaderGroupCreateInfoKHR missGroupInfo = {};
+        missGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
+        missGroupInfo.pNext = nullptr;
+        missGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
+        missGroupInfo.generalShader = 1;
+        missGroupInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
+        missGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
+        missGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
+        missIndex_ = 1;
+
+        VkRayTracingShaderGroupCreateInfoKHR triangleHitGroupInfo = {};
+        triangleHitGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
+        triangleHitGroupInfo.pNext = nullptr;
+        triangleHitGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR;
+        triangleHitGroupInfo.generalShader = VK_SHADER_UNUSED_KHR;
+        triangleHitGroupInfo.closestHitShader = 2;
+        triangleHitGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
+        triangleHitGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
+        triangleHitGroupIndex_ = 2;
+
+        VkRayTracingShaderGroupCreateInfoKHR proceduralHitGroupInfo = {};
+        proceduralHitGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
+        proceduralHitGroupInfo.pNext = nullptr;
+        proceduralHitGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_PROCEDURAL_HIT_GROUP_KHR;
+        proceduralHitGroupInfo.generalShader = VK_SHADER_UNUSED_KHR;
+        proceduralHitGroupInfo.closestHitShader = 3;
+        proceduralHitGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
+        proceduralHitGroupInfo.intersectionShader = 4;
+        proceduralHitGroupIndex_ = 3;
+
+        std::vector<VkRayTracingShaderGroupCreateInfoKHR> groups =
+        {
+            rayGenGroupInfo,
+            missGroupInfo,
+            triangleHitGroupInfo,
+            proceduralHitGroupInfo,
         };
 
-        descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
+        // Create graphic pipeline
+        VkRayTracingPipelineCreateInfoKHR pipelineInfo = {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR;
+        pipelineInfo.pNext = nullptr;
+        pipelineInfo.flags = 0;
+        pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+        pipelineInfo.pStages = shaderStages.data();
+        pipelineInfo.groupCount = static_cast<uint32_t>(groups.size());
+        pipelineInfo.pGroups = groups.data();
+        pipelineInfo.maxPipelineRayRecursionDepth = 1;
+        pipelineInfo.layout = rayTracePipelineLayout_->Handle();
+        pipelineInfo.basePipelineHandle = nullptr;
+        pipelineInfo.basePipelineIndex = 0;
+
+        Check(deviceProcedures.vkCreateRayTracingPipelinesKHR(device.Handle(), nullptr, device.PipelineCache(), 1, &pipelineInfo,
+                                                              nullptr, &pipeline_),
+              "create ray tracing pipeline");
+    }
+
+    RayTracingPipeline::~RayTracingPipeline()
+    {
+        if (pipeline_ != nullptr)
+        {
+            vkDestroyPipeline(device_.Handle(), pipeline_, nullptr);
+            pipeline_ = nullptr;
+        }
+
+        rayTracePipelineLayout_.reset();
+        descriptorSetManager_.reset();
+    }
+
+    bool RayTracingPipeline::IsCompatible(const Assets::Scene& scene, const uint32_t maxBounces) const
+    {
+        return scene.TextureSamplers().size() == textureCount_ && scene.CompactVertices() == compactVertices_ &&
+            maxBounces == maxBounces_;
+    }
+
+    void RayTracingPipeline::UpdateDescriptors(
+        const TopLevelAccelerationStructure& accelerationStructure,
+        const ImageView& accumulationImageView,
+        const ImageView& motionVectorImageView,
+        const ImageView& gbufferImageView,
+        const ImageView& albedoImageView,
+        const ImageView& visibilityBufferImageView,
+        const ImageView& visibility1BufferImageView,
+        const std::vector<Assets::UniformBuffer>& uniformBuffers,
+        const Assets::Scene& scene)
+    {
+        descriptorSetManager_->Reallocate(uniformBuffers.size());
 
         auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
-        for (uint32_t i = 0; i != swapChain.Images().size(); ++i)
+        for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
         {
             // Top level acceleration structure.
             const auto accelerationStructureHandle = accelerationStructure.Handle();
@@ -143,6 +275,19 @@ namespace Vulkan::RayTracing
             lightBufferInfo.buffer = scene.LightBuffer().Handle();
             lightBufferInfo.range = VK_WHOLE_SIZE;
 
+            VkDescriptorBufferInfo lightAliasBufferInfo = {};
+            lightAliasBufferInfo.buffer = scene.LightAliasBuffer().Handle();
+            lightAliasBufferInfo.range = VK_WHOLE_SIZE;
+
+            VkDescriptorBufferInfo skyAliasBufferInfo = {};
+            skyAliasBufferInfo.buffer = scene.SkyAliasBuffer().Handle();
+            skyAliasBufferInfo.range = VK_WHOLE_SIZE;
+
+            // Node buffer
+            VkDescriptorBufferInfo nodesBufferInfo = {};
+            nodesBufferInfo.buffer = scene.NodeMatrixBuffer().Handle();
+            nodesBufferInfo.range = VK_WHOLE_SIZE;
+
             // Image and texture samplers.
             std::vector<VkDescriptorImageInfo> imageInfos(scene.TextureSamplers().size());
 
@@ -158,6 +303,7 @@ namespace Vulkan::RayTracing
             {
                 descriptorSets.Bind(i, 0, structureInfo),
                 descriptorSets.Bind(i, 1, lightBufferInfo),
+                descriptorSets.Bind(i, 2, nodesBufferInfo),
                 descriptorSets.Bind(i, 3, uniformBufferInfo),
                 descriptorSets.Bind(i, 4, vertexBufferInfo),
                 descriptorSets.Bind(i, 5, indexBufferInfo),
@@ -170,6 +316,8 @@ namespace Vulkan::RayTracing
                 descriptorSets.Bind(i, 13, albedoImageInfo),
                 descriptorSets.Bind(i, 14, visibilityBufferImageInfo),
                 descriptorSets.Bind(i, 15, visibility1BufferImageInfo),
+                descriptorSets.Bind(i, 16, lightAliasBufferInfo),
+                descriptorSets.Bind(i, 17, skyAliasBufferInfo),
             };
 
             // Procedural buffer (optional)
@@ -185,136 +333,72 @@ namespace Vulkan::RayTracing
 
             descriptorSets.UpdateDescriptors(i, descriptorWrites);
         }
+    }
 
-        rayTracePipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
-
-        // Load shaders.
-        const ShaderModule rayGenShader(device, "../assets/shaders/RayTracing.rgen.spv");
-        const ShaderModule missShader(device, "../assets/shaders/RayTracing.rmiss.spv");
-        const ShaderModule closestHitShader(device, "../assets/shaders/RayTracing.rchit.spv");
-        const ShaderModule proceduralClosestHitShader(device, "../assets/shaders/RayTracing.Procedural.rchit.spv");
-        const ShaderModule proceduralIntersectionShader(device, "../assets/shaders/RayTracing.Procedural.rint.spv");
+    VkDescriptorSet RayTracingPipeline::DescriptorSet(const uint32_t index) const
+    {
+        return descriptorSetManager_->DescriptorSets().Handle(index);
+    }
 
-        std::vector<VkPipelineShaderStageCreateInfo> shaderStages =
+    DenoiserPipeline::DenoiserPipeline(const Device& device, const size_t descriptorSetCount) : device_(device)
+    {
+        // Create descriptor pool/sets.
+        const std::vector<DescriptorBinding> descriptorBindings =
         {
-            rayGenShader.CreateShaderStage(VK_SHADER_STAGE_RAYGEN_BIT_KHR),
-            missShader.CreateShaderStage(VK_SHADER_STAGE_MISS_BIT_KHR),
-            closestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR),
-            proceduralClosestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR),
-            proceduralIntersectionShader.CreateShaderStage(VK_SHADER_STAGE_INTERSECTION_BIT_KHR),
+            // Image accumulation & output & GBuffer.
+            {0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+            {1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+            {2, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+            {3, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+            // Camera information & co
+            {4, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},
         };
 
-        // Shader groups
-        VkRayTracingShaderGroupCreateInfoKHR rayGenGroupInfo = {};
-        rayGenGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
-        rayGenGroupInfo.pNext = nullptr;
-        rayGenGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
-        rayGenGroupInfo.generalShader = 0;
-        rayGenGroupInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
-        rayGenGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-        rayGenGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-        rayGenIndex_ = 0;
+        descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, descriptorSetCount));
 
-        VkRayTracingShaderGroupCreateInfoKHR missGroupInfo = {};
-        missGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
-        missGroupInfo.pNext = nullptr;
-        missGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
-        missGroupInfo.generalShader = 1;
-        missGroupInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
-        missGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-        missGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-        missIndex_ = 1;
-
-        VkRayTracingShaderGroupCreateInfoKHR triangleHitGroupInfo = {};
-        triangleHitGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
-        triangleHitGroupInfo.pNext = nullptr;
-        triangleHitGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR;
-        triangleHitGroupInfo.generalShader = VK_SHADER_UNUSED_KHR;
-        triangleHitGroupInfo.closestHitShader = 2;
-        triangleHitGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-        triangleHitGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-        triangleHitGroupIndex_ = 2;
+        VkPushConstantRange pushConstantRange{};
+        // Push constants will only be accessible at the selected pipeline stages, for this sample it's the vertex shader that reads them
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = 8;
 
-        VkRayTracingShaderGroupCreateInfoKHR proceduralHitGroupInfo = {};
-        proceduralHitGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
-        proceduralHitGroupInfo.pNext = nullptr;
-        proceduralHitGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_PROCEDURAL_HIT_GROUP_KHR;
-        proceduralHitGroupInfo.generalShader = VK_SHADER_UNUSED_KHR;
-        proceduralHitGroupInfo.closestHitShader = 3;
-        proceduralHitGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-        proceduralHitGroupInfo.intersectionShader = 4;
-        proceduralHitGroupIndex_ = 3;
+        PipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(),
+                                                       &pushConstantRange, 1));
+        const ShaderModule denoiseShader(device, "../assets/shaders/Denoise.comp.spv");
 
-        std::vector<VkRayTracingShaderGroupCreateInfoKHR> groups =
-        {
-            rayGenGroupInfo,
-            missGroupInfo,
-            triangleHitGroupInfo,
-            proceduralHitGroupInfo,
-        };
+        VkComputePipelineCreateInfo pipelineCreateInfo = {};
+        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.stage = denoiseShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT);
+        pipelineCreateInfo.layout = PipelineLayout_->Handle();
 
-        // Create graphic pipeline
-        VkRayTracingPipelineCreateInfoKHR pipelineInfo = {};
-        pipelineInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR;
-        pipelineInfo.pNext = nullptr;
-        pipelineInfo.flags = 0;
-        pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
-        pipelineInfo.pStages = shaderStages.data();
-        pipelineInfo.groupCount = static_cast<uint32_t>(groups.size());
-        pipelineInfo.pGroups = groups.data();
-        pipelineInfo.maxPipelineRayRecursionDepth = 1;
-        pipelineInfo.layout = rayTracePipelineLayout_->Handle();
-        pipelineInfo.basePipelineHandle = nullptr;
-        pipelineInfo.basePipelineIndex = 0;
 
-        Check(deviceProcedures.vkCreateRayTracingPipelinesKHR(device.Handle(), nullptr, nullptr, 1, &pipelineInfo,
-                                                              nullptr, &pipeline_),
-              "create ray tracing pipeline");
+        Check(vkCreateComputePipelines(device.Handle(), device.PipelineCache(),
+                                       1, &pipelineCreateInfo,
+                                       NULL, &pipeline_),
+              "create denoise pipeline");
     }
 
-    RayTracingPipeline::~RayTracingPipeline()
+    DenoiserPipeline::~DenoiserPipeline()
     {
         if (pipeline_ != nullptr)
         {
-            vkDestroyPipeline(swapChain_.Device().Handle(), pipeline_, nullptr);
+            vkDestroyPipeline(device_.Handle(), pipeline_, nullptr);
             pipeline_ = nullptr;
         }
 
-        rayTracePipelineLayout_.reset();
+        PipelineLayout_.reset();
         descriptorSetManager_.reset();
     }
 
-    VkDescriptorSet RayTracingPipeline::DescriptorSet(const uint32_t index) const
+    void DenoiserPipeline::UpdateDescriptors(const ImageView& pingpongImage0View, const ImageView& pingpongImage1View,
+                                             const ImageView& gbufferImageView, const ImageView& albedoImageView,
+                                             const std::vector<Assets::UniformBuffer>& uniformBuffers)
     {
-        return descriptorSetManager_->DescriptorSets().Handle(index);
-    }
-
-    DenoiserPipeline::DenoiserPipeline(const DeviceProcedures& deviceProcedures, const SwapChain& swapChain,
-                                       const TopLevelAccelerationStructure& accelerationStructure,
-                                       const ImageView& pingpongImage0View,
-                                       const ImageView& pingpongImage1View, const ImageView& gbufferImageView,
-                                       const ImageView& albedoImageView,
-                                       const std::vector<Assets::UniformBuffer>& uniformBuffers,
-                                       const Assets::Scene& scene) : swapChain_(swapChain)
-    {
-        // Create descriptor pool/sets.
-        const auto& device = swapChain.Device();
-        const std::vector<DescriptorBinding> descriptorBindings =
-        {
-            // Image accumulation & output & GBuffer.
-            {0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
-            {1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
-            {2, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
-            {3, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
-            // Camera information & co
-            {4, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},
-        };
-
-        descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
+        descriptorSetManager_->Reallocate(uniformBuffers.size());
 
         auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
-        for (uint32_t i = 0; i != swapChain.Images().size(); ++i)
+        for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
         {
             // Accumulation image
             VkDescriptorImageInfo accumulationImageInfo = {};
@@ -352,6 +436,29 @@ namespace Vulkan::RayTracing
 
             descriptorSets.UpdateDescriptors(i, descriptorWrites);
         }
+    }
+
+    VkDescriptorSet DenoiserPipeline::DescriptorSet(uint32_t index) const
+    {
+        return descriptorSetManager_->DescriptorSets().Handle(index);
+    }
+
+    ComposePipeline::ComposePipeline(const Device& device, const size_t descriptorSetCount): device_(device)
+    {
+        // Create descriptor pool/sets.
+        const std::vector<DescriptorBinding> descriptorBindings =
+        {
+            // Image accumulation & output & GBuffer.
+            {0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+            {1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+            {2, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+            {3, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+            // Camera information & co
+            {4, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},
+            {5, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+        };
+
+        descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, descriptorSetCount));
 
         VkPushConstantRange pushConstantRange{};
         // Push constants will only be accessible at the selected pipeline stages, for this sample it's the vertex shader that reads them
@@ -361,7 +468,7 @@ namespace Vulkan::RayTracing
 
         PipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(),
                                                        &pushConstantRange, 1));
-        const ShaderModule denoiseShader(device, "../assets/shaders/Denoise.comp.spv");
+        const ShaderModule denoiseShader(device, "../assets/shaders/Compose.comp.spv");
 
         VkComputePipelineCreateInfo pipelineCreateInfo = {};
         pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
@@ -369,17 +476,17 @@ namespace Vulkan::RayTracing
         pipelineCreateInfo.layout = PipelineLayout_->Handle();
 
 
-        Check(vkCreateComputePipelines(device.Handle(), VK_NULL_HANDLE,
+        Check(vkCreateComputePipelines(device.Handle(), device.PipelineCache(),
                                        1, &pipelineCreateInfo,
                                        NULL, &pipeline_),
-              "create denoise pipeline");
+              "create compose pipeline");
     }
 
-    DenoiserPipeline::~DenoiserPipeline()
+    ComposePipeline::~ComposePipeline()
     {
         if (pipeline_ != nullptr)
         {
-            vkDestroyPipeline(swapChain_.Device().Handle(), pipeline_, nullptr);
+            vkDestroyPipeline(device_.Handle(), pipeline_, nullptr);
             pipeline_ = nullptr;
         }
 
@@ -387,36 +494,16 @@ namespace Vulkan::RayTracing
         descriptorSetManager_.reset();
     }
 
-    VkDescriptorSet DenoiserPipeline::DescriptorSet(uint32_t index) const
+    void ComposePipeline::UpdateDescriptors(const ImageView& final0ImageView, const ImageView& final1ImageView,
+                                            const ImageView& albedoImageView, const ImageView& outImageView,
+                                            const ImageView& motionVectorView,
+                                            const std::vector<Assets::UniformBuffer>& uniformBuffers)
     {
-        return descriptorSetManager_->DescriptorSets().Handle(index);
-    }
-
-    ComposePipeline::ComposePipeline(const DeviceProcedures& deviceProcedures, const SwapChain& swapChain,
-                                     const ImageView& final0ImageView, const ImageView& final1ImageView,
-                                     const ImageView& albedoImageView, const ImageView& outImageView,
-                                     const ImageView& motionVectorView,
-                                     const std::vector<Assets::UniformBuffer>& uniformBuffers): swapChain_(swapChain)
-    {
-        // Create descriptor pool/sets.
-        const auto& device = swapChain.Device();
-        const std::vector<DescriptorBinding> descriptorBindings =
-        {
-            // Image accumulation & output & GBuffer.
-            {0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
-            {1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
-            {2, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
-            {3, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
-            // Camera information & co
-            {4, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},
-            {5, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
-        };
-
-        descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
+        descriptorSetManager_->Reallocate(uniformBuffers.size());
 
         auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
-        for (uint32_t i = 0; i != swapChain.Images().size(); ++i)
+        for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
         {
             VkDescriptorImageInfo Info0 = {NULL, final0ImageView.Handle(), VK_IMAGE_LAYOUT_GENERAL};
             VkDescriptorImageInfo Info1 = {NULL, final1ImageView.Handle(), VK_IMAGE_LAYOUT_GENERAL};
@@ -436,39 +523,6 @@ namespace Vulkan::RayTracing
 
             descriptorSets.UpdateDescriptors(i, descriptorWrites);
         }
-
-        VkPushConstantRange pushConstantRange{};
-        // Push constants will only be accessible at the selected pipeline stages, for this sample it's the vertex shader that reads them
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = 8;
-
-        PipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(),
-                                                       &pushConstantRange, 1));
-        const ShaderModule denoiseShader(device, "../assets/shaders/Compose.comp.spv");
-
-        VkComputePipelineCreateInfo pipelineCreateInfo = {};
-        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-        pipelineCreateInfo.stage = denoiseShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT);
-        pipelineCreateInfo.layout = PipelineLayout_->Handle();
-
-
-        Check(vkCreateComputePipelines(device.Handle(), VK_NULL_HANDLE,
-                                       1, &pipelineCreateInfo,
-                                       NULL, &pipeline_),
-              "create compose pipeline");
-    }
-
-    ComposePipeline::~ComposePipeline()
-    {
-        if (pipeline_ != nullptr)
-        {
-            vkDestroyPipeline(swapChain_.Device().Handle(), pipeline_, nullptr);
-            pipeline_ = nullptr;
-        }
-
-        PipelineLayout_.reset();
-        descriptorSetManager_.reset();
     }
 
     VkDescriptorSet ComposePipeline::DescriptorSet(uint32_t index) const
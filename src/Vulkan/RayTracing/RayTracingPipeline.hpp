@@ -13,9 +13,9 @@ namespace Assets
 namespace Vulkan
 {
 	class DescriptorSetManager;
+	class Device;
 	class ImageView;
 	class PipelineLayout;
-	class SwapChain;
 }
 
 namespace Vulkan::RayTracing
@@ -31,7 +31,18 @@ namespace Vulkan::RayTracing
 
 		RayTracingPipeline(
 			const DeviceProcedures& deviceProcedures,
-			const SwapChain& swapChain,
+			const Device& device,
+			const Assets::Scene& scene,
+			uint32_t maxBounces,
+			size_t descriptorSetCount);
+		~RayTracingPipeline();
+
+		// The layout depends on the texture count and the shaders on the vertex layout and the bounce limit,
+		// anything else about a scene only needs the descriptors to be rewritten.
+		bool IsCompatible(const Assets::Scene& scene, uint32_t maxBounces) const;
+
+		// One descriptor set per uniform buffer, the sets are reallocated if their number changed.
+		void UpdateDescriptors(
 			const TopLevelAccelerationStructure& accelerationStructure,
 			const ImageView& accumulationImageView,
 			const ImageView& motionVectorImageView,
@@ -41,7 +52,6 @@ namespace Vulkan::RayTracing
 			const ImageView& visibility1BufferImageView,
 			const std::vector<Assets::UniformBuffer>& uniformBuffers,
 			const Assets::Scene& scene);
-		~RayTracingPipeline();
 
 		uint32_t RayGenShaderIndex() const { return rayGenIndex_; }
 		uint32_t MissShaderIndex() const { return missIndex_; }
@@ -53,7 +63,10 @@ namespace Vulkan::RayTracing
 
 	private:
 
-		const SwapChain& swapChain_;
+		const class Device& device_;
+		const size_t textureCount_;
+		const bool compactVertices_;
+		const uint32_t maxBounces_;
 
 		VULKAN_HANDLE(VkPipeline, pipeline_)
 
@@ -72,23 +85,21 @@ namespace Vulkan::RayTracing
 
 		VULKAN_NON_COPIABLE(DenoiserPipeline)
 
-		DenoiserPipeline(
-			const DeviceProcedures& deviceProcedures,
-			const SwapChain& swapChain,
-			const TopLevelAccelerationStructure& accelerationStructure,
+		DenoiserPipeline(const Device& device, size_t descriptorSetCount);
+		~DenoiserPipeline();
+
+		void UpdateDescriptors(
 			const ImageView& pingpongImage0View,
 			const ImageView& pingpongImage1View,
 			const ImageView& gbufferImageView,
 			const ImageView& albedoImageView,
-			const std::vector<Assets::UniformBuffer>& uniformBuffers,
-			const Assets::Scene& scene);
-		~DenoiserPipeline();
+			const std::vector<Assets::UniformBuffer>& uniformBuffers);
 
 		VkDescriptorSet DescriptorSet(uint32_t index) const;
 		const class PipelineLayout& PipelineLayout() const { return *PipelineLayout_; }
 	private:
 
-		const SwapChain& swapChain_;
+		const class Device& device_;
 
 		VULKAN_HANDLE(VkPipeline, pipeline_)
 
@@ -102,22 +113,22 @@ namespace Vulkan::RayTracing
 
 		VULKAN_NON_COPIABLE(ComposePipeline)
 
-		ComposePipeline(
-			const DeviceProcedures& deviceProcedures,
-			const SwapChain& swapChain,
+		ComposePipeline(const Device& device, size_t descriptorSetCount);
+		~ComposePipeline();
+
+		void UpdateDescriptors(
 			const ImageView& final0ImageView,
 			const ImageView& final1ImageView,
 			const ImageView& albedoImageView,
 			const ImageView& outImageView,
 			const ImageView& motionVectorView,
 			const std::vector<Assets::UniformBuffer>& uniformBuffers);
-		~ComposePipeline();
 
 		VkDescriptorSet DescriptorSet(uint32_t index) const;
 		const class PipelineLayout& PipelineLayout() const { return *PipelineLayout_; }
 	private:
 
-		const SwapChain& swapChain_;
+		const class Device& device_;
 
 		VULKAN_HANDLE(VkPipeline, pipeline_)
 
@@ -6,16 +6,23 @@
 #include "TopLevelAccelerationStructure.hpp"
 #include "Assets/Model.hpp"
 #include "Assets/Scene.hpp"
+#include "Utilities/Exception.hpp"
 #include "Utilities/Glm.hpp"
+#include "Utilities/Tracer.hpp"
+#include "Options.hpp"
 #include "Vulkan/Buffer.hpp"
 #include "Vulkan/BufferUtil.hpp"
+#include "Vulkan/GpuProfiler.hpp"
 #include "Vulkan/Image.hpp"
 #include "Vulkan/ImageMemoryBarrier.hpp"
 #include "Vulkan/ImageView.hpp"
 #include "Vulkan/PipelineLayout.hpp"
+#include "Vulkan/QueryPool.hpp"
 #include "Vulkan/SingleTimeCommands.hpp"
 #include "Vulkan/SwapChain.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <numeric>
 
@@ -57,6 +64,7 @@ namespace Vulkan::RayTracing
     RayTracingRenderer::~RayTracingRenderer()
     {
         RayTracingRenderer::DeleteSwapChain();
+        DeletePipelines();
         DeleteAccelerationStructures();
         rayTracingProperties_.reset();
         deviceProcedures_.reset();         
@@ -68,6 +76,12 @@ namespace Vulkan::RayTracing
         VkPhysicalDeviceFeatures& deviceFeatures,
         void* nextDeviceFeatures)
     {
+        // The accumulation and visibility images are rg32ui storage images.
+        if (!deviceFeatures.shaderStorageImageExtendedFormats)
+        {
+            Throw(std::runtime_error("the ray tracing renderer requires shaderStorageImageExtendedFormats, use --renderer=2 instead"));
+        }
+
         supportRayTracing_ = true;
         
         // Required extensions.
@@ -102,16 +116,41 @@ namespace Vulkan::RayTracing
 
     void RayTracingRenderer::CreateAccelerationStructures()
     {
+        TRACE_ZONE("CreateAccelerationStructures");
+
         const auto timer = std::chrono::high_resolution_clock::now();
 
-        SingleTimeCommands::Submit(CommandPool(), [this](VkCommandBuffer commandBuffer)
+        if (GOption != nullptr && GOption->CompactBlas)
         {
-            CreateBottomLevelStructures(commandBuffer);
-            CreateTopLevelStructures(commandBuffer);
-        });
+            // The compacted sizes are only known once the builds have executed, so this takes three submits:
+            // build + size queries, compacting copies, then the TLAS on top of the compacted BLASes.
+            const auto& scene = GetScene();
+            const uint32_t bottomCount = static_cast<uint32_t>(scene.Models().size() +
+                (scene.ProceduralCount() + ProceduralsPerBlas - 1) / ProceduralsPerBlas);
+            const QueryPool compactedSizes(Device(), VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, std::max(1u, bottomCount));
+
+            SingleTimeCommands::Submit(CommandPool(), [this, &compactedSizes](VkCommandBuffer commandBuffer)
+            {
+                CreateBottomLevelStructures(commandBuffer, &compactedSizes);
+            });
 
-        topScratchBuffer_.reset();
-        topScratchBufferMemory_.reset();
+            CompactBottomLevelStructures(compactedSizes);
+
+            SingleTimeCommands::Submit(CommandPool(), [this](VkCommandBuffer commandBuffer)
+            {
+                CreateTopLevelStructures(commandBuffer);
+            });
+        }
+        else
+        {
+            SingleTimeCommands::Submit(CommandPool(), [this](VkCommandBuffer commandBuffer)
+            {
+                CreateBottomLevelStructures(commandBuffer, nullptr);
+                CreateTopLevelStructures(commandBuffer);
+            });
+        }
+
+        // The TLAS scratch buffer is kept around for refitting moved nodes.
         bottomScratchBuffer_.reset();
         bottomScratchBufferMemory_.reset();
 
@@ -123,8 +162,14 @@ namespace Vulkan::RayTracing
     void RayTracingRenderer::DeleteAccelerationStructures()
     {
         topAs_.clear();
+        if (mappedInstances_ != nullptr)
+        {
+            instancesBufferMemory_->Unmap();
+            mappedInstances_ = nullptr;
+        }
         instancesBuffer_.reset();
         instancesBufferMemory_.reset();
+        nodeInstances_.clear();
         topScratchBuffer_.reset();
         topScratchBufferMemory_.reset();
         topBuffer_.reset();
@@ -142,18 +187,16 @@ namespace Vulkan::RayTracing
         Vulkan::VulkanBaseRenderer::CreateSwapChain();
 
         CreateOutputImage();
+        CreatePipelines();
 
-        rayTracingPipeline_.reset(new RayTracingPipeline(*deviceProcedures_, SwapChain(), topAs_[0],
-                                                         *accumulationImageView_, *motionVectorImageView_,
-                                                         *gbufferImageView_, *albedoImageView_, *visibilityBufferImageView_, *visibility1BufferImageView_,
-                                                         UniformBuffers(), GetScene()));
-        denoiserPipeline_.reset(new DenoiserPipeline(*deviceProcedures_, SwapChain(), topAs_[0], *pingpongImage0View_,
-                                                     *pingpongImage1View_, *gbufferImageView_, *albedoImageView_,
-                                                     UniformBuffers(), GetScene()));
-        composePipeline_.reset(new ComposePipeline(*deviceProcedures_, SwapChain(), *pingpongImage0View_, *pingpongImage1View_,
-                                                   *albedoImageView_, *outputImageView_, *motionVectorImageView_, UniformBuffers()));
-
-        accumulatePipeline_.reset(new PipelineCommon::AccumulatePipeline(SwapChain(),
+        // Only the size dependent images and the per swap chain image uniform buffers change, rewrite the descriptors.
+        UpdateRayTracingDescriptors();
+        denoiserPipeline_->UpdateDescriptors(*pingpongImage0View_, *pingpongImage1View_, *gbufferImageView_, *albedoImageView_,
+                                             UniformBuffers());
+        composePipeline_->UpdateDescriptors(*pingpongImage0View_, *pingpongImage1View_,
+                                            *albedoImageView_, *outputImageView_, *motionVectorImageView_, UniformBuffers());
+
+        accumulatePipeline_->UpdateDescriptors(
             *accumulationImageView_,
             *pingpongImage0View_,
             *pingpongImage1View_,
@@ -161,28 +204,73 @@ namespace Vulkan::RayTracing
             *visibilityBufferImageView_,
             *visibility1BufferImageView_,
             *validateImageView_,
-            UniformBuffers(), GetScene()));
-    
-        
-        const std::vector<ShaderBindingTable::Entry> rayGenPrograms = {{rayTracingPipeline_->RayGenShaderIndex(), {}}};
-        const std::vector<ShaderBindingTable::Entry> missPrograms = {{rayTracingPipeline_->MissShaderIndex(), {}}};
-        const std::vector<ShaderBindingTable::Entry> hitGroups = {
-            {rayTracingPipeline_->TriangleHitGroupIndex(), {}}, {rayTracingPipeline_->ProceduralHitGroupIndex(), {}}
-        };
-
-        shaderBindingTable_.reset(new ShaderBindingTable(*deviceProcedures_, *rayTracingPipeline_,
-                                                         *rayTracingProperties_, rayGenPrograms, missPrograms,
-                                                         hitGroups));     
-        
+            UniformBuffers());
     }
 
-    void RayTracingRenderer::DeleteSwapChain()
+    void RayTracingRenderer::CreatePipelines()
+    {
+        const auto& scene = GetScene();
+        const auto descriptorSetCount = UniformBuffers().size();
+
+        // The pipelines live as long as the device. The ray tracing one (and its SBT) is only rebuilt when a newly
+        // loaded scene changes its layout or the bounce limit changes, the compute ones never.
+        if (!rayTracingPipeline_ || !rayTracingPipeline_->IsCompatible(scene, maxBounces_))
+        {
+            const auto timer = std::chrono::high_resolution_clock::now();
+
+            shaderBindingTable_.reset();
+            rayTracingPipeline_.reset(new RayTracingPipeline(*deviceProcedures_, Device(), scene, maxBounces_, descriptorSetCount));
+
+            const std::vector<ShaderBindingTable::Entry> rayGenPrograms = {{rayTracingPipeline_->RayGenShaderIndex(), {}}};
+            const std::vector<ShaderBindingTable::Entry> missPrograms = {{rayTracingPipeline_->MissShaderIndex(), {}}};
+            const std::vector<ShaderBindingTable::Entry> hitGroups = {
+                {rayTracingPipeline_->TriangleHitGroupIndex(), {}}, {rayTracingPipeline_->ProceduralHitGroupIndex(), {}}
+            };
+
+            shaderBindingTable_.reset(new ShaderBindingTable(*deviceProcedures_, *rayTracingPipeline_,
+                                                             *rayTracingProperties_, rayGenPrograms, missPrograms,
+                                                             hitGroups));
+
+            const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(
+                std::chrono::high_resolution_clock::now() - timer).count();
+            std::cout << "- created ray tracing pipeline in " << elapsed << "s" << std::endl;
+        }
+
+        if (!denoiserPipeline_)
+        {
+            denoiserPipeline_.reset(new DenoiserPipeline(Device(), descriptorSetCount));
+            composePipeline_.reset(new ComposePipeline(Device(), descriptorSetCount));
+            accumulatePipeline_.reset(new PipelineCommon::AccumulatePipeline(Device(), descriptorSetCount));
+        }
+    }
+
+    void RayTracingRenderer::UpdateRayTracingDescriptors()
+    {
+        rayTracingPipeline_->UpdateDescriptors(topAs_[0],
+                                               *accumulationImageView_, *motionVectorImageView_,
+                                               *gbufferImageView_, *albedoImageView_, *visibilityBufferImageView_, *visibility1BufferImageView_,
+                                               UniformBuffers(), GetScene());
+    }
+
+    void RayTracingRenderer::OnMaxBouncesChanged()
+    {
+        // The bounce limit is a specialization constant, only the ray tracing pipeline and its SBT depend on it.
+        Device().WaitIdle();
+        CreatePipelines();
+        UpdateRayTracingDescriptors();
+    }
+
+    void RayTracingRenderer::DeletePipelines()
     {
         shaderBindingTable_.reset();
         accumulatePipeline_.reset();
         rayTracingPipeline_.reset();
         denoiserPipeline_.reset();
         composePipeline_.reset();
+    }
+
+    void RayTracingRenderer::DeleteSwapChain()
+    {
         outputImageView_.reset();
         outputImage_.reset();
         pingpongImage0_.reset();
@@ -230,6 +318,14 @@ namespace Vulkan::RayTracing
         subresourceRange.baseArrayLayer = 0;
         subresourceRange.layerCount = 1;
 
+        // Every sample is in, the output image still holds the last composed frame. Present it again and leave
+        // the rest of the pipeline idle.
+        if (frameConverged_)
+        {
+            CopyOutputImage(commandBuffer, imageIndex, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+            return;
+        }
+
         // Acquire destination images for rendering.
         ImageMemoryBarrier::Insert(commandBuffer, accumulationImage_->Handle(), subresourceRange, 0,
                                    VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
@@ -282,10 +378,12 @@ namespace Vulkan::RayTracing
         VkStridedDeviceAddressRegionKHR callableShaderBindingTable = {};
 
         // Execute ray tracing shaders.
+        GpuProfiler().BeginZone(commandBuffer, "Trace Rays");
         deviceProcedures_->vkCmdTraceRaysKHR(commandBuffer,
                                              &raygenShaderBindingTable, &missShaderBindingTable, &hitShaderBindingTable,
                                              &callableShaderBindingTable,
                                              CheckerboxRendering() ? extent.width / 2 : extent.width, extent.height, 1);
+        GpuProfiler().EndZone(commandBuffer);
 
 
         ImageMemoryBarrier::Insert(commandBuffer, pingpongImage0_->Handle(), subresourceRange, 0,
@@ -308,16 +406,19 @@ namespace Vulkan::RayTracing
         // frame0: new + image 0 -> image 1
         // frame1: new + image 1 -> image 0
         {
+            GpuProfiler().BeginZone(commandBuffer, "Accumulate");
             VkDescriptorSet DescriptorSets[] = {accumulatePipeline_->DescriptorSet(imageIndex)};
             vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, accumulatePipeline_->Handle());
             vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
                                     accumulatePipeline_->PipelineLayout().Handle(), 0, 1, DescriptorSets, 0, nullptr);
             vkCmdDispatch(commandBuffer, SwapChain().Extent().width / 8, SwapChain().Extent().height / 4, 1);
+            GpuProfiler().EndZone(commandBuffer);
         }
 
         // ping & pong denoise
         // frame0: image 1 -> image 0 -> image 1 -> image 0 -> image 1
         // frame1: image 0 -> image 1 -> image 0 -> image 1 -> image 0
+        GpuProfiler().BeginZone(commandBuffer, "Denoise");
         for (int i = 0; i < denoiseIteration_ * 2; i++)
         {
             // pingpong & stepsize via push constants
@@ -345,9 +446,11 @@ namespace Vulkan::RayTracing
                                        VK_ACCESS_SHADER_WRITE_BIT,
                                        VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
         }
+        GpuProfiler().EndZone(commandBuffer);
 
         // compose with first bounce
         {
+            GpuProfiler().BeginZone(commandBuffer, "Compose");
             DenoiserPushConstantData pushData;
             pushData.pingpong = frameCount_ % 2;
             pushData.stepsize = 1;
@@ -360,11 +463,28 @@ namespace Vulkan::RayTracing
             vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
                                     composePipeline_->PipelineLayout().Handle(), 0, 1, denoiserDescriptorSets, 0, nullptr);
             vkCmdDispatch(commandBuffer, extent.width / 8, extent.height / 4, 1);
+            GpuProfiler().EndZone(commandBuffer);
         }
 
+        CopyOutputImage(commandBuffer, imageIndex, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+    }
+
+    void RayTracingRenderer::CopyOutputImage(VkCommandBuffer commandBuffer, const uint32_t imageIndex,
+                                             const VkAccessFlags outputAccess, const VkImageLayout outputLayout)
+    {
+        const auto extent = SwapChain().Extent();
+
+        VkImageSubresourceRange subresourceRange = {};
+        subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        subresourceRange.baseMipLevel = 0;
+        subresourceRange.levelCount = 1;
+        subresourceRange.baseArrayLayer = 0;
+        subresourceRange.layerCount = 1;
+
         // Acquire output image and swap-chain image for copying.
+        GpuProfiler().BeginZone(commandBuffer, "Copy");
         ImageMemoryBarrier::Insert(commandBuffer, outputImage_->Handle(), subresourceRange,
-                                   VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                                   outputAccess, VK_ACCESS_TRANSFER_READ_BIT, outputLayout,
                                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
 
         ImageMemoryBarrier::Insert(commandBuffer, SwapChain().Images()[imageIndex], subresourceRange, 0,
@@ -387,6 +507,7 @@ namespace Vulkan::RayTracing
         ImageMemoryBarrier::Insert(commandBuffer, SwapChain().Images()[imageIndex], subresourceRange,
                                    VK_ACCESS_TRANSFER_WRITE_BIT,
                                    0, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        GpuProfiler().EndZone(commandBuffer);
     }
 
     void RayTracingRenderer::OnPreLoadScene()
@@ -401,34 +522,80 @@ namespace Vulkan::RayTracing
         CreateAccelerationStructures();
     }
 
-    void RayTracingRenderer::CreateBottomLevelStructures(VkCommandBuffer commandBuffer)
+    void RayTracingRenderer::CreateBottomLevelStructures(VkCommandBuffer commandBuffer, const QueryPool* compactedSizes)
     {
         const auto& scene = GetScene();
         const auto& debugUtils = Device().DebugUtils();
 
         // Bottom level acceleration structure
-        // Triangles via vertex buffers. Procedurals via AABBs.
+        // Triangles via vertex buffers, one BLAS per model.
         uint32_t vertexOffset = 0;
         uint32_t indexOffset = 0;
-        uint32_t aabbOffset = 0;
+
+        modelBottomAs_.clear();
 
         for (auto& model : scene.Models())
         {
             const auto vertexCount = static_cast<uint32_t>(model.NumberOfVertices());
             const auto indexCount = static_cast<uint32_t>(model.NumberOfIndices());
-            BottomLevelGeometry geometries;
 
-            model.Procedural()
-                ? geometries.AddGeometryAabb(scene, aabbOffset, 1, true)
-                : geometries.AddGeometryTriangles(scene, vertexOffset, vertexCount, indexOffset, indexCount, true);
+            if (model.Procedural())
+            {
+                modelBottomAs_.push_back(-1);
+            }
+            else
+            {
+                BottomLevelGeometry geometries;
+                geometries.AddGeometryTriangles(scene, vertexOffset, vertexCount, indexOffset, indexCount, true);
 
-            bottomAs_.emplace_back(*deviceProcedures_, *rayTracingProperties_, geometries);
+                modelBottomAs_.push_back(static_cast<int32_t>(bottomAs_.size()));
+                bottomAs_.emplace_back(*deviceProcedures_, *rayTracingProperties_, geometries, compactedSizes != nullptr);
+            }
 
-            vertexOffset += vertexCount * sizeof(Assets::Vertex);
+            vertexOffset += vertexCount * scene.VertexStride();
             indexOffset += indexCount * sizeof(uint32_t);
-            aabbOffset += sizeof(VkAabbPositionsKHR);
         }
 
+        // Procedurals via AABBs, already in world space, batched into as few BLASes as possible.
+        proceduralBottomAs_ = static_cast<uint32_t>(bottomAs_.size());
+
+        for (uint32_t first = 0; first < scene.ProceduralCount(); first += ProceduralsPerBlas)
+        {
+            const auto count = std::min(ProceduralsPerBlas, scene.ProceduralCount() - first);
+            BottomLevelGeometry geometries;
+            geometries.AddGeometryAabb(scene, first * sizeof(VkAabbPositionsKHR), count, true);
+
+            bottomAs_.emplace_back(*deviceProcedures_, *rayTracingProperties_, geometries, compactedSizes != nullptr);
+        }
+
+        if (scene.ProceduralCount() != 0)
+        {
+            std::cout << "- packed " << scene.ProceduralCount() << " procedurals into "
+                << bottomAs_.size() - proceduralBottomAs_ << " BLAS" << std::endl;
+        }
+
+        // Split the builds into batches whose scratch memory fits in the budget, the scratch buffer is shared
+        // by all batches. A structure needing more than the budget on its own gets a batch to itself.
+        const VkDeviceSize scratchBudget = static_cast<VkDeviceSize>(GOption != nullptr ? GOption->BlasScratchBudget : 64) * 1024 * 1024;
+        std::vector<size_t> batchEnds;
+        VkDeviceSize scratchSize = 0;
+        VkDeviceSize batchScratchSize = 0;
+
+        for (size_t i = 0; i != bottomAs_.size(); ++i)
+        {
+            const auto size = bottomAs_[i].BuildSizes().buildScratchSize;
+            if (batchScratchSize != 0 && batchScratchSize + size > scratchBudget)
+            {
+                batchEnds.push_back(i);
+                batchScratchSize = 0;
+            }
+
+            batchScratchSize += size;
+            scratchSize = std::max(scratchSize, batchScratchSize);
+        }
+
+        batchEnds.push_back(bottomAs_.size());
+
         // Allocate the structures memory.
         const auto total = GetTotalRequirements(bottomAs_);
 
@@ -437,7 +604,7 @@ namespace Vulkan::RayTracing
                                        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT));
         bottomBufferMemory_.reset(new DeviceMemory(
             bottomBuffer_->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
-        bottomScratchBuffer_.reset(new Buffer(Device(), total.buildScratchSize,
+        bottomScratchBuffer_.reset(new Buffer(Device(), scratchSize,
                                               VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR |
                                               VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
                                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
@@ -446,23 +613,125 @@ namespace Vulkan::RayTracing
                                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 
         debugUtils.SetObjectName(bottomBuffer_->Handle(), "BLAS Buffer");
-        debugUtils.SetObjectName(bottomBufferMemory_->Handle(), "BLAS Memory");
+        bottomBufferMemory_->SetName("BLAS");
         debugUtils.SetObjectName(bottomScratchBuffer_->Handle(), "BLAS Scratch Buffer");
-        debugUtils.SetObjectName(bottomScratchBufferMemory_->Handle(), "BLAS Scratch Memory");
+        bottomScratchBufferMemory_->SetName("BLAS Scratch");
 
-        // Generate the structures.
+        // Generate the structures, one build call per batch.
+        std::vector<VkAccelerationStructureBuildGeometryInfoKHR> buildInfos;
+        std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> buildRanges;
         VkDeviceSize resultOffset = 0;
-        VkDeviceSize scratchOffset = 0;
+        size_t first = 0;
+
+        for (const size_t end : batchEnds)
+        {
+            if (first == end)
+            {
+                continue;
+            }
+
+            // The previous batch has to be done with the scratch memory before it is reused.
+            if (first != 0)
+            {
+                AccelerationStructure::MemoryBarrier(commandBuffer);
+            }
+
+            buildInfos.clear();
+            buildRanges.clear();
+            VkDeviceSize scratchOffset = 0;
+
+            for (size_t i = first; i != end; ++i)
+            {
+                bottomAs_[i].PrepareBuild(*bottomScratchBuffer_, scratchOffset, *bottomBuffer_, resultOffset);
+                buildInfos.push_back(bottomAs_[i].BuildGeometryInfo());
+                buildRanges.push_back(bottomAs_[i].BuildRangeInfo());
+
+                resultOffset += bottomAs_[i].BuildSizes().accelerationStructureSize;
+                scratchOffset += bottomAs_[i].BuildSizes().buildScratchSize;
+
+                debugUtils.SetObjectName(bottomAs_[i].Handle(), ("BLAS #" + std::to_string(i)).c_str());
+            }
+
+            deviceProcedures_->vkCmdBuildAccelerationStructuresKHR(
+                commandBuffer, static_cast<uint32_t>(buildInfos.size()), buildInfos.data(), buildRanges.data());
+
+            first = end;
+        }
+
+        std::cout << "- building " << bottomAs_.size() << " BLAS in " << batchEnds.size() << " batches with "
+            << scratchSize / 1024 << " KB of scratch (" << total.buildScratchSize / 1024 << " KB unbatched)" << std::endl;
+
+        if (compactedSizes != nullptr && !bottomAs_.empty())
+        {
+            std::vector<VkAccelerationStructureKHR> handles;
+            handles.reserve(bottomAs_.size());
+            for (const auto& blas : bottomAs_)
+            {
+                handles.push_back(blas.Handle());
+            }
+
+            // The builds have to be finished before their compacted size can be queried.
+            AccelerationStructure::MemoryBarrier(commandBuffer);
+
+            compactedSizes->Reset(commandBuffer);
+            deviceProcedures_->vkCmdWriteAccelerationStructuresPropertiesKHR(
+                commandBuffer, static_cast<uint32_t>(handles.size()), handles.data(),
+                VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, compactedSizes->Handle(), 0);
+        }
+    }
+
+    void RayTracingRenderer::CompactBottomLevelStructures(const QueryPool& compactedSizes)
+    {
+        const auto& debugUtils = Device().DebugUtils();
+        const auto sizes = compactedSizes.GetResults(static_cast<uint32_t>(bottomAs_.size()));
+
+        // Acceleration structures have to start on a 256 bytes boundary.
+        const VkDeviceSize alignment = 256;
+        std::vector<VkDeviceSize> offsets(bottomAs_.size());
+        VkDeviceSize uncompactedSize = 0;
+        VkDeviceSize compactedSize = 0;
 
         for (size_t i = 0; i != bottomAs_.size(); ++i)
         {
-            bottomAs_[i].Generate(commandBuffer, *bottomScratchBuffer_, scratchOffset, *bottomBuffer_, resultOffset);
+            offsets[i] = compactedSize;
+            uncompactedSize += bottomAs_[i].BuildSizes().accelerationStructureSize;
+            compactedSize += (sizes[i] + alignment - 1) / alignment * alignment;
+        }
+
+        if (compactedSize == 0)
+        {
+            return;
+        }
 
-            resultOffset += bottomAs_[i].BuildSizes().accelerationStructureSize;
-            scratchOffset += bottomAs_[i].BuildSizes().buildScratchSize;
+        std::unique_ptr<Buffer> compactedBuffer(new Buffer(Device(), compactedSize,
+                                                           VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR |
+                                                           VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT));
+        std::unique_ptr<DeviceMemory> compactedMemory(new DeviceMemory(
+            compactedBuffer->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 
+        SingleTimeCommands::Submit(CommandPool(), [&](VkCommandBuffer commandBuffer)
+        {
+            for (size_t i = 0; i != bottomAs_.size(); ++i)
+            {
+                bottomAs_[i].Compact(commandBuffer, sizes[i], *compactedBuffer, offsets[i]);
+            }
+        });
+
+        // The copies are done, drop the uncompacted structures and their memory.
+        for (size_t i = 0; i != bottomAs_.size(); ++i)
+        {
+            bottomAs_[i].ReleaseCompactionSource();
             debugUtils.SetObjectName(bottomAs_[i].Handle(), ("BLAS #" + std::to_string(i)).c_str());
         }
+
+        bottomBuffer_ = std::move(compactedBuffer);
+        bottomBufferMemory_ = std::move(compactedMemory);
+
+        debugUtils.SetObjectName(bottomBuffer_->Handle(), "BLAS Buffer");
+        bottomBufferMemory_->SetName("BLAS");
+
+        std::cout << "- compacted " << bottomAs_.size() << " BLAS from " << uncompactedSize << " to " << compactedSize
+            << " bytes (" << 100.0 * static_cast<double>(compactedSize) / static_cast<double>(uncompactedSize) << "%)" << std::endl;
     }
 
     void RayTracingRenderer::CreateTopLevelStructures(VkCommandBuffer commandBuffer)
@@ -473,25 +742,52 @@ namespace Vulkan::RayTracing
         // Top level acceleration structure
         std::vector<VkAccelerationStructureInstanceKHR> instances;
 
-        // Hit group 0: triangles
-        // Hit group 1: procedurals
-        for (const auto& node : scene.Nodes())
+        // Hit group 0: triangles, the custom index is the node's slot in the NodeProxy buffer (grouped by model).
+        nodeInstances_.assign(scene.Nodes().size(), -1);
+        for (uint32_t m = 0; m != scene.Models().size(); ++m)
+        {
+            if (modelBottomAs_[m] < 0)
+            {
+                continue;
+            }
+
+            for (uint32_t n = 0; n != scene.Nodes().size(); ++n)
+            {
+                const auto& node = scene.Nodes()[n];
+                if (node.GetModel() != static_cast<int>(m))
+                {
+                    continue;
+                }
+
+                nodeInstances_[n] = static_cast<int32_t>(instances.size());
+                instances.push_back(TopLevelAccelerationStructure::CreateInstance(
+                    bottomAs_[modelBottomAs_[m]], glm::transpose(node.WorldTransform()), scene.NodeProxySlot(n), 0));
+            }
+        }
+
+        // Hit group 1: procedurals, the custom index is the first primitive of the batch in the Procedurals buffer.
+        for (uint32_t i = proceduralBottomAs_, first = 0; i != bottomAs_.size(); ++i, first += ProceduralsPerBlas)
         {
             instances.push_back(TopLevelAccelerationStructure::CreateInstance(
-                bottomAs_[node.GetModel()], glm::transpose(node.WorldTransform()), node.GetModel(),  node.IsProcedural() ? 1 : 0));
+                bottomAs_[i], glm::mat4(1), first, 1));
         }
 
-        // Create and copy instances buffer (do it in a separate one-time synchronous command buffer).
-        BufferUtil::CreateDeviceBuffer(CommandPool(), "TLAS Instances",
-                                       VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
-                                       VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, instances, instancesBuffer_,
-                                       instancesBufferMemory_);
+        // Create the instances buffer, it stays mapped so moved nodes can be patched in place.
+        const auto instancesSize = sizeof(VkAccelerationStructureInstanceKHR) * std::max<size_t>(1, instances.size());
+        instancesBuffer_.reset(new Buffer(Device(), instancesSize,
+                                          VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+                                          VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT));
+        instancesBufferMemory_.reset(new DeviceMemory(
+            instancesBuffer_->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+                                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+        mappedInstances_ = static_cast<VkAccelerationStructureInstanceKHR*>(instancesBufferMemory_->Map(0, instancesSize));
+        std::copy(instances.begin(), instances.end(), mappedInstances_);
 
         // Memory barrier for the bottom level acceleration structure builds.
         AccelerationStructure::MemoryBarrier(commandBuffer);
 
         topAs_.emplace_back(*deviceProcedures_, *rayTracingProperties_, instancesBuffer_->GetDeviceAddress(),
-                            static_cast<uint32_t>(instances.size()));
+                            static_cast<uint32_t>(instances.size()), true);
 
         // Allocate the structure memory.
         const auto total = GetTotalRequirements(topAs_);
@@ -500,7 +796,7 @@ namespace Vulkan::RayTracing
                                     VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR));
         topBufferMemory_.reset(new DeviceMemory(topBuffer_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 
-        topScratchBuffer_.reset(new Buffer(Device(), total.buildScratchSize,
+        topScratchBuffer_.reset(new Buffer(Device(), std::max(total.buildScratchSize, total.updateScratchSize),
                                            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR |
                                            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
@@ -510,11 +806,11 @@ namespace Vulkan::RayTracing
 
 
         debugUtils.SetObjectName(topBuffer_->Handle(), "TLAS Buffer");
-        debugUtils.SetObjectName(topBufferMemory_->Handle(), "TLAS Memory");
+        topBufferMemory_->SetName("TLAS");
         debugUtils.SetObjectName(topScratchBuffer_->Handle(), "TLAS Scratch Buffer");
-        debugUtils.SetObjectName(topScratchBufferMemory_->Handle(), "TLAS Scratch Memory");
+        topScratchBufferMemory_->SetName("TLAS Scratch");
         debugUtils.SetObjectName(instancesBuffer_->Handle(), "TLAS Instances Buffer");
-        debugUtils.SetObjectName(instancesBufferMemory_->Handle(), "TLAS Instances Memory");
+        instancesBufferMemory_->SetName("TLAS Instances");
 
         // Generate the structures.
         topAs_[0].Generate(commandBuffer, *topScratchBuffer_, 0, *topBuffer_, 0);
@@ -522,6 +818,91 @@ namespace Vulkan::RayTracing
         debugUtils.SetObjectName(topAs_[0].Handle(), "TLAS");
     }
 
+    void RayTracingRenderer::OnNodesMoved(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& nodes)
+    {
+        if (topAs_.empty())
+        {
+            return;
+        }
+
+        const auto& scene = GetScene();
+        bool moved = false;
+
+        // The previous frame has completed by the time the next one is recorded, nothing reads the instances now.
+        for (const uint32_t n : nodes)
+        {
+            if (nodeInstances_[n] < 0)
+            {
+                continue;
+            }
+
+            const glm::mat4 transform = glm::transpose(scene.Nodes()[n].WorldTransform());
+            std::memcpy(&mappedInstances_[nodeInstances_[n]].transform, &transform, sizeof(VkTransformMatrixKHR));
+            moved = true;
+        }
+
+        if (!moved)
+        {
+            return;
+        }
+
+        topAs_[0].Update(commandBuffer, *topScratchBuffer_, 0);
+
+        // The refit has to be finished before the rays are traced.
+        VkMemoryBarrier memoryBarrier = {};
+        memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memoryBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+        memoryBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                             VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    std::vector<uint32_t> RayTracingRenderer::ReadPrimaryHitInstances()
+    {
+        const auto extent = SwapChain().Extent();
+        const size_t pixelCount = static_cast<size_t>(extent.width) * extent.height;
+        const auto size = pixelCount * sizeof(glm::uvec2);
+
+        Buffer readback(Device(), size, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+        auto readbackMemory = readback.AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        Device().WaitIdle();
+
+        SingleTimeCommands::Submit(CommandPool(), [&](VkCommandBuffer commandBuffer)
+        {
+            VkImageSubresourceRange subresourceRange = {};
+            subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            subresourceRange.baseMipLevel = 0;
+            subresourceRange.levelCount = 1;
+            subresourceRange.baseArrayLayer = 0;
+            subresourceRange.layerCount = 1;
+
+            // The visibility buffer stays in the general layout between frames.
+            ImageMemoryBarrier::Insert(commandBuffer, visibilityBufferImage_->Handle(), subresourceRange,
+                                       VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                                       VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
+
+            VkBufferImageCopy region = {};
+            region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+            region.imageExtent = {extent.width, extent.height, 1};
+
+            vkCmdCopyImageToBuffer(commandBuffer, visibilityBufferImage_->Handle(), VK_IMAGE_LAYOUT_GENERAL,
+                                   readback.Handle(), 1, &region);
+        });
+
+        // Texels are (instance, material), only the instance is kept.
+        std::vector<uint32_t> instances(pixelCount);
+        const auto* texels = static_cast<const glm::uvec2*>(readbackMemory.Map(0, size));
+        for (size_t i = 0; i != pixelCount; ++i)
+        {
+            instances[i] = texels[i].x;
+        }
+        readbackMemory.Unmap();
+
+        return instances;
+    }
+
     void RayTracingRenderer::CreateOutputImage()
     {
         const auto extent = SwapChain().Extent();
@@ -573,21 +954,21 @@ namespace Vulkan::RayTracing
                                                    VK_IMAGE_ASPECT_COLOR_BIT) );
 
         visibilityBufferImage_.reset(new Image(Device(), extent,
-        VK_FORMAT_R32_UINT, VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT));
+        VK_FORMAT_R32G32_UINT, VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
         visibilityBufferImageMemory_.reset(
             new DeviceMemory(visibilityBufferImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
         visibilityBufferImageView_.reset(new ImageView(Device(), visibilityBufferImage_->Handle(),
-            VK_FORMAT_R32_UINT,
+            VK_FORMAT_R32G32_UINT,
             VK_IMAGE_ASPECT_COLOR_BIT));
 
         visibility1BufferImage_.reset(new Image(Device(), extent,
-        VK_FORMAT_R32_UINT, VK_IMAGE_TILING_OPTIMAL,
+        VK_FORMAT_R32G32_UINT, VK_IMAGE_TILING_OPTIMAL,
         VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT));
         visibility1BufferImageMemory_.reset(
             new DeviceMemory(visibility1BufferImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
         visibility1BufferImageView_.reset(new ImageView(Device(), visibility1BufferImage_->Handle(),
-            VK_FORMAT_R32_UINT,
+            VK_FORMAT_R32G32_UINT,
             VK_IMAGE_ASPECT_COLOR_BIT));
 
         validateImage_.reset(new Image(Device(), extent,
@@ -602,15 +983,23 @@ namespace Vulkan::RayTracing
         const auto& debugUtils = Device().DebugUtils();
 
         debugUtils.SetObjectName(accumulationImage_->Handle(), "Accumulation Image");
-        debugUtils.SetObjectName(accumulationImageMemory_->Handle(), "Accumulation Image Memory");
+        accumulationImageMemory_->SetName("Accumulation Image");
         debugUtils.SetObjectName(accumulationImageView_->Handle(), "Accumulation ImageView");
 
         debugUtils.SetObjectName(outputImage_->Handle(), "Output Image");
-        debugUtils.SetObjectName(outputImageMemory_->Handle(), "Output Image Memory");
+        outputImageMemory_->SetName("Output Image");
         debugUtils.SetObjectName(outputImageView_->Handle(), "Output ImageView");
 
         debugUtils.SetObjectName(gbufferImage_->Handle(), "Gbuffer Image");
-        debugUtils.SetObjectName(gbufferImageMemory_->Handle(), "Gbuffer Image Memory");
+        gbufferImageMemory_->SetName("Gbuffer Image");
         debugUtils.SetObjectName(gbufferImageView_->Handle(), "Gbuffer ImageView");
+
+        pingpongImage0Memory_->SetName("Pingpong Image");
+        pingpongImage1Memory_->SetName("Pingpong Image");
+        albedoImageMemory_->SetName("Albedo Image");
+        motionVectorImageMemory_->SetName("Motion Vector Image");
+        visibilityBufferImageMemory_->SetName("Visibility Image");
+        visibility1BufferImageMemory_->SetName("Visibility Image");
+        validateImageMemory_->SetName("Validate Image");
     }
 }
@@ -15,6 +15,7 @@ namespace Vulkan
 	class DeviceMemory;
 	class Image;
 	class ImageView;
+	class QueryPool;
 }
 
 namespace Vulkan::RayTracing
@@ -41,20 +42,35 @@ namespace Vulkan::RayTracing
 		void CreateSwapChain() override;
 		void DeleteSwapChain() override;
 		void Render(VkCommandBuffer commandBuffer, uint32_t imageIndex) override;
+		bool SupportsConvergedIdle() const override { return true; }
 
 		virtual void OnPreLoadScene() override;
 		virtual void OnPostLoadScene() override;
+		void OnNodesMoved(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& nodes) override;
+		void OnMaxBouncesChanged() override;
+		std::vector<uint32_t> ReadPrimaryHitInstances() override;
+		int32_t NodeInstance(uint32_t nodeIndex) const override { return nodeInstances_[nodeIndex]; }
 
 	private:
 
-		void CreateBottomLevelStructures(VkCommandBuffer commandBuffer);
+		void CreateBottomLevelStructures(VkCommandBuffer commandBuffer, const QueryPool* compactedSizes);
+		void CompactBottomLevelStructures(const QueryPool& compactedSizes);
 		void CreateTopLevelStructures(VkCommandBuffer commandBuffer);
 		void CreateOutputImage();
+		void CreatePipelines();
+		void UpdateRayTracingDescriptors();
+		void DeletePipelines();
+		void CopyOutputImage(VkCommandBuffer commandBuffer, uint32_t imageIndex, VkAccessFlags outputAccess, VkImageLayout outputLayout);
 
 		std::unique_ptr<class DeviceProcedures> deviceProcedures_;
 		std::unique_ptr<class RayTracingProperties> rayTracingProperties_;
 
+		// Upper bound of AABBs per procedural BLAS.
+		static constexpr uint32_t ProceduralsPerBlas = 4096;
+
 		std::vector<class BottomLevelAccelerationStructure> bottomAs_;
+		std::vector<int32_t> modelBottomAs_;
+		uint32_t proceduralBottomAs_{};
 		std::unique_ptr<Buffer> bottomBuffer_;
 		std::unique_ptr<DeviceMemory> bottomBufferMemory_;
 		std::unique_ptr<Buffer> bottomScratchBuffer_;
@@ -64,8 +80,11 @@ namespace Vulkan::RayTracing
 		std::unique_ptr<DeviceMemory> topBufferMemory_;
 		std::unique_ptr<Buffer> topScratchBuffer_;
 		std::unique_ptr<DeviceMemory> topScratchBufferMemory_;
+		// Host visible and persistently mapped, moved nodes are written straight into it before the TLAS refit.
 		std::unique_ptr<Buffer> instancesBuffer_;
 		std::unique_ptr<DeviceMemory> instancesBufferMemory_;
+		VkAccelerationStructureInstanceKHR* mappedInstances_{};
+		std::vector<int32_t> nodeInstances_;
 
 		std::unique_ptr<Image> accumulationImage_;
 		std::unique_ptr<DeviceMemory> accumulationImageMemory_;
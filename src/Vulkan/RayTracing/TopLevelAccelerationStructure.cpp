@@ -12,8 +12,10 @@ TopLevelAccelerationStructure::TopLevelAccelerationStructure(
 	const class DeviceProcedures& deviceProcedures,
 	const class RayTracingProperties& rayTracingProperties,
 	const VkDeviceAddress instanceAddress,
-	const uint32_t instancesCount) :
-	AccelerationStructure(deviceProcedures, rayTracingProperties),
+	const uint32_t instancesCount,
+	const bool allowUpdate) :
+	AccelerationStructure(deviceProcedures, rayTracingProperties,
+		VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | (allowUpdate ? VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR : 0)),
 	instancesCount_(instancesCount)
 {
 	// Create VkAccelerationStructureGeometryInstancesDataKHR. This wraps a device pointer to the above uploaded instances.
@@ -70,10 +72,29 @@ void TopLevelAccelerationStructure::Generate(
 	deviceProcedures_.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &buildGeometryInfo_, &pBuildOffsetInfo);
 }
 
+void TopLevelAccelerationStructure::Update(
+	VkCommandBuffer commandBuffer,
+	Buffer& scratchBuffer,
+	const VkDeviceSize scratchOffset)
+{
+	VkAccelerationStructureBuildRangeInfoKHR buildOffsetInfo = {};
+	buildOffsetInfo.primitiveCount = instancesCount_;
+
+	const VkAccelerationStructureBuildRangeInfoKHR* pBuildOffsetInfo = &buildOffsetInfo;
+
+	VkAccelerationStructureBuildGeometryInfoKHR updateInfo = buildGeometryInfo_;
+	updateInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+	updateInfo.srcAccelerationStructure = Handle();
+	updateInfo.dstAccelerationStructure = Handle();
+	updateInfo.scratchData.deviceAddress = scratchBuffer.GetDeviceAddress() + scratchOffset;
+
+	deviceProcedures_.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &updateInfo, &pBuildOffsetInfo);
+}
+
 VkAccelerationStructureInstanceKHR TopLevelAccelerationStructure::CreateInstance(
 	const BottomLevelAccelerationStructure& bottomLevelAs,
 	const glm::mat4& transform,
-	const uint32_t modelId,
+	const uint32_t instanceId,
 	const uint32_t hitGroupId)
 {
 	const auto& device = bottomLevelAs.Device();
@@ -86,7 +107,7 @@ VkAccelerationStructureInstanceKHR TopLevelAccelerationStructure::CreateInstance
 	const VkDeviceAddress address = deviceProcedure.vkGetAccelerationStructureDeviceAddressKHR(device.Handle(), &addressInfo);
 
 	VkAccelerationStructureInstanceKHR instance = {};
-	instance.instanceCustomIndex = modelId;
+	instance.instanceCustomIndex = instanceId;
 	instance.mask = 0xFF; // The visibility mask is always set of 0xFF, but if some instances would need to be ignored in some cases, this flag should be passed by the application.
 	instance.instanceShaderBindingTableRecordOffset = hitGroupId; // Set the hit group index, that will be used to find the shader code to execute when hitting the geometry.
 	instance.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR; // Disable culling - more fine control could be provided by the application
@@ -20,7 +20,8 @@ namespace Vulkan::RayTracing
 			const class DeviceProcedures& deviceProcedures,
 			const class RayTracingProperties& rayTracingProperties,
 			VkDeviceAddress instanceAddress, 
-			uint32_t instancesCount);
+			uint32_t instancesCount,
+			bool allowUpdate = false);
 		TopLevelAccelerationStructure(TopLevelAccelerationStructure&& other) noexcept;
 		virtual ~TopLevelAccelerationStructure();
 
@@ -31,6 +32,13 @@ namespace Vulkan::RayTracing
 			Buffer& resultBuffer,
 			VkDeviceSize resultOffset);
 
+		// Refits the structure in place after instance transforms changed, needs allowUpdate and
+		// BuildSizes().updateScratchSize bytes of scratch memory.
+		void Update(
+			VkCommandBuffer commandBuffer,
+			Buffer& scratchBuffer,
+			VkDeviceSize scratchOffset);
+
 		static VkAccelerationStructureInstanceKHR CreateInstance(
 			const BottomLevelAccelerationStructure& bottomLevelAs,
 			const glm::mat4& transform,
@@ -20,7 +20,7 @@ namespace Vulkan
 
 		const class Device& Device() const { return device_; }
 
-		VkPipelineShaderStageCreateInfo CreateShaderStage(VkShaderStageFlagBits stage) const;
+		VkPipelineShaderStageCreateInfo CreateShaderStage(VkShaderStageFlagBits stage, const VkSpecializationInfo* specialization = nullptr) const;
 
 	private:
 
@@ -7,6 +7,12 @@ namespace Vulkan {
 Surface::Surface(const class Instance& instance) :
 	instance_(instance)
 {
+	// Headless rendering never presents, the handle stays null.
+	if (instance.Window().Config().Headless)
+	{
+		return;
+	}
+
 	Check(glfwCreateWindowSurface(instance.Handle(), instance.Window().Handle(), nullptr, &surface_),
 		"create window surface");
 }
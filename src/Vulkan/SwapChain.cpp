@@ -1,6 +1,7 @@
 #include "SwapChain.hpp"
 #include "Device.hpp"
 #include "Enumerate.hpp"
+#include "Image.hpp"
 #include "ImageView.hpp"
 #include "Instance.hpp"
 #include "Surface.hpp"
@@ -15,6 +16,13 @@ SwapChain::SwapChain(const class Device& device, const VkPresentModeKHR presentM
 	physicalDevice_(device.PhysicalDevice()),
 	device_(device)
 {
+	if (device.Surface().Handle() == nullptr)
+	{
+		CreateOffscreenImages(device.Surface().Instance().Window(), presentMode);
+		CreateImageViews();
+		return;
+	}
+
 	const auto details = QuerySwapChainSupport(device.PhysicalDevice(), device.Surface().Handle());
 	if (details.Formats.empty() || details.PresentModes.empty())
 	{
@@ -67,25 +75,15 @@ SwapChain::SwapChain(const class Device& device, const VkPresentModeKHR presentM
 	format_ = surfaceFormat.format;
 	extent_ = extent;
 	images_ = GetEnumerateVector(device_.Handle(), swapChain_, vkGetSwapchainImagesKHR);
-	imageViews_.reserve(images_.size());
-
-	for (const auto image : images_)
-	{
-		imageViews_.push_back(std::make_unique<ImageView>(device, image, format_, VK_IMAGE_ASPECT_COLOR_BIT));
-	}
-
-	const auto& debugUtils = device.DebugUtils();
 
-	for (size_t i = 0; i != images_.size(); ++i)
-	{
-		debugUtils.SetObjectName(images_[i], ("Swapchain Image #" + std::to_string(i)).c_str());
-		debugUtils.SetObjectName(imageViews_[i]->Handle(), ("Swapchain ImageView #" + std::to_string(i)).c_str());
-	}
+	CreateImageViews();
 }
 
 SwapChain::~SwapChain()
 {
 	imageViews_.clear();
+	offscreenImages_.clear();
+	offscreenImageMemories_.clear();
 
 	if (swapChain_ != nullptr)
 	{
@@ -219,4 +217,41 @@ uint32_t SwapChain::ChooseImageCount(const VkSurfaceCapabilitiesKHR& capabilitie
 	return imageCount;
 }
 
+void SwapChain::CreateOffscreenImages(const Window& window, const VkPresentModeKHR presentMode)
+{
+	// Same 10 bit layout as the HDR10 swap chains, so the screenshot readback and encoding do not need to care.
+	const uint32_t imageCount = 2;
+
+	minImageCount_ = imageCount;
+	presentMode_ = presentMode;
+	format_ = VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+	extent_ = window.FramebufferSize();
+
+	for (uint32_t i = 0; i != imageCount; ++i)
+	{
+		offscreenImages_.emplace_back(new Image(device_, extent_, format_, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+		offscreenImageMemories_.emplace_back(new DeviceMemory(offscreenImages_.back()->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+		images_.push_back(offscreenImages_.back()->Handle());
+	}
+}
+
+void SwapChain::CreateImageViews()
+{
+	imageViews_.reserve(images_.size());
+
+	for (const auto image : images_)
+	{
+		imageViews_.push_back(std::make_unique<ImageView>(device_, image, format_, VK_IMAGE_ASPECT_COLOR_BIT));
+	}
+
+	const auto& debugUtils = device_.DebugUtils();
+
+	for (size_t i = 0; i != images_.size(); ++i)
+	{
+		debugUtils.SetObjectName(images_[i], ("Swapchain Image #" + std::to_string(i)).c_str());
+		debugUtils.SetObjectName(imageViews_[i]->Handle(), ("Swapchain ImageView #" + std::to_string(i)).c_str());
+	}
+}
+
 }
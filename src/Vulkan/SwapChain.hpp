@@ -7,6 +7,8 @@
 namespace Vulkan
 {
 	class Device;
+	class DeviceMemory;
+	class Image;
 	class ImageView;
 	class Window;
 
@@ -28,6 +30,9 @@ namespace Vulkan
 		VkFormat Format() const { return format_; }
 		VkPresentModeKHR PresentMode() const { return presentMode_; }
 
+		// Headless devices have no surface, the images are then plain device images that are never presented.
+		bool IsOffscreen() const { return swapChain_ == nullptr; }
+
 	private:
 
 		struct SupportDetails
@@ -43,6 +48,9 @@ namespace Vulkan
 		static VkExtent2D ChooseSwapExtent(const Window& window, const VkSurfaceCapabilitiesKHR& capabilities);
 		static uint32_t ChooseImageCount(const VkSurfaceCapabilitiesKHR& capabilities);
 
+		void CreateOffscreenImages(const Window& window, VkPresentModeKHR presentMode);
+		void CreateImageViews();
+
 		const VkPhysicalDevice physicalDevice_;
 		const class Device& device_;
 
@@ -54,6 +62,9 @@ namespace Vulkan
 		VkExtent2D extent_{};
 		std::vector<VkImage> images_;
 		std::vector<std::unique_ptr<ImageView>> imageViews_;
+
+		std::vector<std::unique_ptr<Image>> offscreenImages_;
+		std::vector<std::unique_ptr<DeviceMemory>> offscreenImageMemories_;
 	};
 
 }
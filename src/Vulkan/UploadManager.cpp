@@ -0,0 +1,178 @@
+#include "UploadManager.hpp"
+#include "Buffer.hpp"
+#include "CommandBuffers.hpp"
+#include "CommandPool.hpp"
+#include "Device.hpp"
+#include "DeviceMemory.hpp"
+#include "Fence.hpp"
+#include "Image.hpp"
+#include <cstring>
+#include <limits>
+
+namespace Vulkan {
+
+namespace
+{
+	// Satisfies the buffer offset rules of vkCmdCopyBufferToImage for every texel format we upload.
+	const VkDeviceSize StagingAlignment = 16;
+}
+
+UploadManager::UploadManager(CommandPool& commandPool, const VkDeviceSize stagingSize) :
+	commandPool_(commandPool),
+	stagingSize_(stagingSize)
+{
+	stagingBuffer_.reset(new Buffer(Device(), stagingSize_, VK_BUFFER_USAGE_TRANSFER_SRC_BIT));
+	stagingBufferMemory_.reset(new DeviceMemory(stagingBuffer_->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+	stagingBufferMemory_->SetName("Upload Staging");
+	staging_ = static_cast<char*>(stagingBufferMemory_->Map(0, stagingSize_));
+}
+
+UploadManager::~UploadManager()
+{
+	Wait();
+
+	stagingBufferMemory_->Unmap();
+	stagingBuffer_.reset();
+	stagingBufferMemory_.reset(); // release memory after bound buffer has been destroyed
+}
+
+const Device& UploadManager::Device() const
+{
+	return commandPool_.Device();
+}
+
+void UploadManager::UploadBuffer(Buffer& dstBuffer, const void* const data, const VkDeviceSize size, const VkDeviceSize dstOffset)
+{
+	const Buffer* stagingBuffer;
+	VkDeviceSize stagingOffset;
+	Stage(data, size, stagingBuffer, stagingOffset);
+
+	VkBufferCopy copyRegion = {};
+	copyRegion.srcOffset = stagingOffset;
+	copyRegion.dstOffset = dstOffset;
+	copyRegion.size = size;
+
+	vkCmdCopyBuffer(Recording(), stagingBuffer->Handle(), dstBuffer.Handle(), 1, &copyRegion);
+}
+
+void UploadManager::UploadImage(Image& dstImage, const void* const data, const VkDeviceSize size)
+{
+	const Buffer* stagingBuffer;
+	VkDeviceSize stagingOffset;
+	Stage(data, size, stagingBuffer, stagingOffset);
+
+	const auto commandBuffer = Recording();
+
+	dstImage.TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	dstImage.CopyFrom(commandBuffer, *stagingBuffer, stagingOffset);
+	dstImage.TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void UploadManager::Flush()
+{
+	if (!recording_)
+	{
+		return;
+	}
+
+	const auto commandBuffer = (*recording_->CommandBuffer)[0];
+
+	// Make the copies visible to whatever runs on the queue afterwards (vertex input, shaders, AS builds).
+	VkMemoryBarrier memoryBarrier = {};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+		1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+	Check(vkEndCommandBuffer(commandBuffer), "end upload command buffer");
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	Check(vkQueueSubmit(Device().GraphicsQueue(), 1, &submitInfo, recording_->Fence->Handle()),
+		"submit upload command buffer");
+
+	pending_.push_back(std::move(recording_));
+	submitCount_++;
+}
+
+void UploadManager::Wait()
+{
+	Flush();
+	WaitPending();
+}
+
+VkCommandBuffer UploadManager::Recording()
+{
+	if (!recording_)
+	{
+		recording_.reset(new Batch());
+		recording_->CommandBuffer.reset(new CommandBuffers(commandPool_, 1));
+		recording_->Fence.reset(new class Fence(Device(), false));
+
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		Check(vkBeginCommandBuffer((*recording_->CommandBuffer)[0], &beginInfo),
+			"begin upload command buffer");
+	}
+
+	return (*recording_->CommandBuffer)[0];
+}
+
+void UploadManager::Stage(const void* const data, const VkDeviceSize size, const Buffer*& stagingBuffer, VkDeviceSize& stagingOffset)
+{
+	uploadedBytes_ += size;
+
+	if (size > stagingSize_)
+	{
+		std::unique_ptr<Buffer> buffer(new Buffer(Device(), size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT));
+		std::unique_ptr<DeviceMemory> memory(new DeviceMemory(buffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+
+		std::memcpy(memory->Map(0, size), data, size);
+		memory->Unmap();
+
+		Recording();
+		stagingBuffer = buffer.get();
+		stagingOffset = 0;
+
+		recording_->OversizeBuffers.push_back(std::move(buffer));
+		recording_->OversizeMemories.push_back(std::move(memory));
+		return;
+	}
+
+	stagingOffset = (head_ + StagingAlignment - 1) / StagingAlignment * StagingAlignment;
+
+	// The ring is full, everything in flight has to complete before it can be reused from the start.
+	if (stagingOffset + size > stagingSize_)
+	{
+		Wait();
+		stagingOffset = 0;
+	}
+
+	std::memcpy(staging_ + stagingOffset, data, size);
+	head_ = stagingOffset + size;
+	stagingBuffer = stagingBuffer_.get();
+}
+
+void UploadManager::WaitPending()
+{
+	for (auto& batch : pending_)
+	{
+		batch->Fence->Wait(std::numeric_limits<uint64_t>::max());
+
+		// Delete the buffers before the memory
+		batch->OversizeBuffers.clear();
+		batch->OversizeMemories.clear();
+	}
+
+	pending_.clear();
+	head_ = 0;
+}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include <memory>
+#include <vector>
+
+namespace Vulkan
+{
+	class Buffer;
+	class CommandBuffers;
+	class CommandPool;
+	class Device;
+	class DeviceMemory;
+	class Fence;
+	class Image;
+
+	// Streams buffer and image contents to the device through one persistent staging ring.
+	// Copies are recorded into a shared command buffer, which is submitted with a fence when the ring runs out
+	// of space or on Flush(), rather than one staging buffer and one queue drain per upload.
+	// Nothing uploaded may be used before Wait() has returned.
+	class UploadManager final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(UploadManager)
+
+		explicit UploadManager(CommandPool& commandPool, VkDeviceSize stagingSize = 64 * 1024 * 1024);
+		~UploadManager();
+
+		const class Device& Device() const;
+
+		void UploadBuffer(Buffer& dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+		// The image ends up in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+		void UploadImage(Image& dstImage, const void* data, VkDeviceSize size);
+
+		void Flush();
+		void Wait();
+
+		uint32_t SubmitCount() const { return submitCount_; }
+		VkDeviceSize UploadedBytes() const { return uploadedBytes_; }
+
+	private:
+
+		struct Batch
+		{
+			std::unique_ptr<CommandBuffers> CommandBuffer;
+			std::unique_ptr<class Fence> Fence;
+			// Dedicated staging for uploads larger than the whole ring.
+			std::vector<std::unique_ptr<Buffer>> OversizeBuffers;
+			std::vector<std::unique_ptr<DeviceMemory>> OversizeMemories;
+		};
+
+		VkCommandBuffer Recording();
+		void Stage(const void* data, VkDeviceSize size, const Buffer*& stagingBuffer, VkDeviceSize& stagingOffset);
+		void WaitPending();
+
+		CommandPool& commandPool_;
+		const VkDeviceSize stagingSize_;
+
+		std::unique_ptr<Buffer> stagingBuffer_;
+		std::unique_ptr<DeviceMemory> stagingBufferMemory_;
+		char* staging_{};
+		VkDeviceSize head_{};
+
+		std::unique_ptr<Batch> recording_;
+		std::vector<std::unique_ptr<Batch>> pending_;
+
+		uint32_t submitCount_{};
+		VkDeviceSize uploadedBytes_{};
+	};
+
+}
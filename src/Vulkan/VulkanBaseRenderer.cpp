@@ -7,6 +7,7 @@
 #include "Device.hpp"
 #include "Fence.hpp"
 #include "FrameBuffer.hpp"
+#include "GpuProfiler.hpp"
 #include "GraphicsPipeline.hpp"
 #include "Instance.hpp"
 #include "PipelineLayout.hpp"
@@ -19,6 +20,7 @@
 #include "Assets/Scene.hpp"
 #include "Assets/UniformBuffer.hpp"
 #include "Utilities/Exception.hpp"
+#include "Utilities/Tracer.hpp"
 #include <array>
 
 #include "ImageMemoryBarrier.hpp"
@@ -44,6 +46,12 @@ VulkanBaseRenderer::~VulkanBaseRenderer()
 {
 	VulkanBaseRenderer::DeleteSwapChain();
 
+	if (device_)
+	{
+		device_->SavePipelineCache();
+	}
+
+	gpuProfiler_.reset();
 	commandPool_.reset();
 	device_.reset();
 	surface_.reset();
@@ -82,7 +90,15 @@ void VulkanBaseRenderer::SetPhysicalDevice(VkPhysicalDevice physicalDevice)
 		VK_KHR_SWAPCHAIN_EXTENSION_NAME,
 	};
 
+	// gl_PrimitiveID in fragment shaders (visibility buffer) needs the geometry shader capability.
+	// Only enabled where supported, the modern deferred renderer falls back to flattened geometry otherwise.
+	VkPhysicalDeviceFeatures supportedFeatures = {};
+	vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
 	VkPhysicalDeviceFeatures deviceFeatures = {};
+	deviceFeatures.geometryShader = supportedFeatures.geometryShader;
+	// The rg32ui visibility buffers are storage images of an extended format.
+	deviceFeatures.shaderStorageImageExtendedFormats = supportedFeatures.shaderStorageImageExtendedFormats;
 	
 	SetPhysicalDeviceImpl(physicalDevice, requiredExtensions, deviceFeatures, nullptr);
 	OnDeviceSet();
@@ -133,6 +149,11 @@ void VulkanBaseRenderer::SetPhysicalDeviceImpl(
 
 void VulkanBaseRenderer::OnDeviceSet()
 {
+	// Every pipeline of every renderer goes through this one cache, so resizes and scene switches only pay
+	// for pipeline compilation on the very first run.
+	device_->LoadPipelineCache("../assets/shaders/pipelines.cache");
+
+	gpuProfiler_.reset(new class GpuProfiler(*device_));
 }
 
 void VulkanBaseRenderer::CreateSwapChain()
@@ -187,11 +208,14 @@ void VulkanBaseRenderer::DeleteSwapChain()
 
 void VulkanBaseRenderer::DrawFrame()
 {
+	TRACE_ZONE("DrawFrame");
+
 	const auto noTimeout = std::numeric_limits<uint64_t>::max();
 
 	// wait the last frame command buffer to complete
 	if(fence)
 	{
+		TRACE_ZONE("Wait Fence");
 		fence->Wait(noTimeout);
 	}
 
@@ -199,9 +223,23 @@ void VulkanBaseRenderer::DrawFrame()
 	fence = &(inFlightFences_[currentFrame_]);
 	const auto imageAvailableSemaphore = imageAvailableSemaphores_[currentFrame_].Handle();
 	const auto renderFinishedSemaphore = renderFinishedSemaphores_[currentFrame_].Handle();
+	const bool offscreen = swapChain_->IsOffscreen();
 
 	uint32_t imageIndex;
-	auto result = vkAcquireNextImageKHR(device_->Handle(), swapChain_->Handle(), noTimeout, imageAvailableSemaphore, nullptr, &imageIndex);
+	VkResult result;
+	if (offscreen)
+	{
+		// No presentation engine hands out images, they simply take turns. The fence of this slot guards the
+		// command buffer and uniform buffer of the image as well.
+		imageIndex = static_cast<uint32_t>(currentFrame_);
+		fence->Wait(noTimeout);
+		result = VK_SUCCESS;
+	}
+	else
+	{
+		TRACE_ZONE("Acquire");
+		result = vkAcquireNextImageKHR(device_->Handle(), swapChain_->Handle(), noTimeout, imageAvailableSemaphore, nullptr, &imageIndex);
+	}
 
 	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || isWireFrame_ != graphicsPipeline_->IsWireFrame())
 	{
@@ -215,7 +253,11 @@ void VulkanBaseRenderer::DrawFrame()
 	}
 
 	const auto commandBuffer = commandBuffers_->Begin(imageIndex);
-	Render(commandBuffer, imageIndex);
+	{
+		TRACE_ZONE("Record");
+		gpuProfiler_->BeginFrame(commandBuffer);
+		Render(commandBuffer, imageIndex);
+	}
 
 	// screenshot swapchain image
 	if (supportScreenShot_)
@@ -267,18 +309,28 @@ void VulkanBaseRenderer::DrawFrame()
 	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 	VkSemaphore signalSemaphores[] = { renderFinishedSemaphore };
 
-	submitInfo.waitSemaphoreCount = 1;
+	submitInfo.waitSemaphoreCount = offscreen ? 0 : 1;
 	submitInfo.pWaitSemaphores = waitSemaphores;
 	submitInfo.pWaitDstStageMask = waitStages;
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = commandBuffers;
-	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.signalSemaphoreCount = offscreen ? 0 : 1;
 	submitInfo.pSignalSemaphores = signalSemaphores;
 
 	fence->Reset();
 
-	Check(vkQueueSubmit(device_->GraphicsQueue(), 1, &submitInfo, fence->Handle()),
-		"submit draw command buffer");
+	{
+		TRACE_ZONE("Submit");
+		Check(vkQueueSubmit(device_->GraphicsQueue(), 1, &submitInfo, fence->Handle()),
+			"submit draw command buffer");
+	}
+
+	if (offscreen)
+	{
+		currentFrame_ = (currentFrame_ + 1) % inFlightFences_.size();
+		frameCount_ += frameConverged_ ? 0 : 1;
+		return;
+	}
 
 	VkSwapchainKHR swapChains[] = { swapChain_->Handle() };
 	VkPresentInfoKHR presentInfo = {};
@@ -290,7 +342,10 @@ void VulkanBaseRenderer::DrawFrame()
 	presentInfo.pImageIndices = &imageIndex;
 	presentInfo.pResults = nullptr; // Optional
 
-	result = vkQueuePresentKHR(device_->PresentQueue(), &presentInfo);
+	{
+		TRACE_ZONE("Present");
+		result = vkQueuePresentKHR(device_->PresentQueue(), &presentInfo);
+	}
 	
 	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
 	{
@@ -305,7 +360,8 @@ void VulkanBaseRenderer::DrawFrame()
 
 	currentFrame_ = (currentFrame_ + 1) % inFlightFences_.size();
 
-	frameCount_++;
+	// A converged frame skipped the ping-pong passes, the next traced frame must pick up their parity where it was.
+	frameCount_ += frameConverged_ ? 0 : 1;
 }
 
 void VulkanBaseRenderer::Render(VkCommandBuffer commandBuffer, const uint32_t imageIndex)
@@ -323,6 +379,7 @@ void VulkanBaseRenderer::Render(VkCommandBuffer commandBuffer, const uint32_t im
 	renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 	renderPassInfo.pClearValues = clearValues.data();
 	
+	gpuProfiler_->BeginZone(commandBuffer, "Raster");
 	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 	{
 		const auto& scene = GetScene();
@@ -339,24 +396,30 @@ void VulkanBaseRenderer::Render(VkCommandBuffer commandBuffer, const uint32_t im
 
 		uint32_t vertexOffset = 0;
 		uint32_t indexOffset = 0;
+		uint32_t instanceOffset = 0;
 
 		// drawcall
-		for (const auto& model : scene.Models())
+		for (uint32_t m = 0; m < scene.Models().size(); m++)
 		{
+			const auto& model = scene.Models()[m];
 			const auto vertexCount = static_cast<uint32_t>(model.NumberOfVertices());
 			const auto indexCount = static_cast<uint32_t>(model.NumberOfIndices());
+			const auto instanceCount = static_cast<uint32_t>(scene.ModelInstanceCount()[m]);
 
-			vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
+			vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, indexOffset, vertexOffset, instanceOffset);
 
 			vertexOffset += vertexCount;
 			indexOffset += indexCount;
+			instanceOffset += instanceCount;
 		}
 	}
 	vkCmdEndRenderPass(commandBuffer);
+	gpuProfiler_->EndZone(commandBuffer);
 }
 
 void VulkanBaseRenderer::UpdateUniformBuffer(const uint32_t imageIndex)
 {
+	TRACE_ZONE("Update Uniforms");
 	uniformBuffers_[imageIndex].SetValue(GetUniformBufferObject(swapChain_->Extent()));
 }
 
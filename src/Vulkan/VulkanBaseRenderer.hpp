@@ -47,6 +47,8 @@ namespace Vulkan
 		const std::vector<Assets::UniformBuffer>& UniformBuffers() const { return uniformBuffers_; }
 		const class GraphicsPipeline& GraphicsPipeline() const { return *graphicsPipeline_; }
 		const class FrameBuffer& SwapChainFrameBuffer(const size_t i) const { return swapChainFramebuffers_[i]; }
+		class GpuProfiler& GpuProfiler() { return *gpuProfiler_; }
+		const class GpuProfiler& GpuProfiler() const { return *gpuProfiler_; }
 		const bool CheckerboxRendering() {return checkerboxRendering_;}
 		
 		virtual const Assets::Scene& GetScene() const = 0;
@@ -64,8 +66,21 @@ namespace Vulkan
 		virtual void DrawFrame();
 		virtual void Render(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 
+		// Whether Render() honours frameConverged_ by presenting the last output without running its passes.
+		virtual bool SupportsConvergedIdle() const { return false; }
+
+		// Called once maxBounces_ has changed, renderers specialized for it rebuild what depends on it.
+		virtual void OnMaxBouncesChanged() {}
+
 		virtual void OnPreLoadScene() {}
 		virtual void OnPostLoadScene() {}
+		// Called before Render() when nodes have been moved, after the Nodes buffer update has been recorded.
+		virtual void OnNodesMoved(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& nodes) {}
+		// Instance of the primary hit of every pixel in the last traced frame (~0u on a miss), empty when the renderer
+		// keeps no such buffer. Waits for the device.
+		virtual std::vector<uint32_t> ReadPrimaryHitInstances() { return {}; }
+		// Instance the primary hits report for a node, -1 when it has none.
+		virtual int32_t NodeInstance(uint32_t nodeIndex) const { return -1; }
 
 		virtual void OnKey(int key, int scancode, int action, int mods) { }
 		virtual void OnCursorPosition(double xpos, double ypos) { }
@@ -76,7 +91,11 @@ namespace Vulkan
 		bool checkerboxRendering_{};
 		bool supportRayTracing_ {};
 		int denoiseIteration_{};
+		// Path length the ray tracing pipeline is specialized for.
+		uint32_t maxBounces_{};
 		int frameCount_{};
+		// Set by the application once accumulation is complete and the renderer supports converged idle.
+		bool frameConverged_{};
 		bool supportScreenShot_{};
 
 		DeviceMemory* GetScreenShotMemory() const {return screenShotImageMemory_.get();}
@@ -99,6 +118,7 @@ namespace Vulkan
 		std::vector<class FrameBuffer> swapChainFramebuffers_;
 		std::unique_ptr<class CommandPool> commandPool_;
 		std::unique_ptr<class CommandBuffers> commandBuffers_;
+		std::unique_ptr<class GpuProfiler> gpuProfiler_;
 		std::vector<class Semaphore> imageAvailableSemaphores_;
 		std::vector<class Semaphore> renderFinishedSemaphores_;
 		std::vector<class Fence> inFlightFences_;
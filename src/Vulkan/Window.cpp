@@ -52,6 +52,13 @@ namespace
 Window::Window(const WindowConfig& config) :
 	config_(config)
 {
+	// Machines without a display server cannot even initialise GLFW.
+	if (config.Headless)
+	{
+		startTime_ = std::chrono::steady_clock::now();
+		return;
+	}
+
 	glfwSetErrorCallback(GlfwErrorCallback);
 
 	if (!glfwInit())
@@ -99,6 +106,11 @@ Window::Window(const WindowConfig& config) :
 
 Window::~Window()
 {
+	if (config_.Headless)
+	{
+		return;
+	}
+
 	if (window_ != nullptr)
 	{
 		glfwDestroyWindow(window_);
@@ -111,6 +123,11 @@ Window::~Window()
 
 float Window::ContentScale() const
 {
+	if (config_.Headless)
+	{
+		return 1.0f;
+	}
+
 	float xscale;
 	float yscale;
 	glfwGetWindowContentScale(window_, &xscale, &yscale);
@@ -120,6 +137,11 @@ float Window::ContentScale() const
 
 VkExtent2D Window::FramebufferSize() const
 {
+	if (config_.Headless)
+	{
+		return VkExtent2D{ config_.Width, config_.Height };
+	}
+
 	int width, height;
 	glfwGetFramebufferSize(window_, &width, &height);
 	return VkExtent2D{ static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
@@ -127,6 +149,11 @@ VkExtent2D Window::FramebufferSize() const
 
 VkExtent2D Window::WindowSize() const
 {
+	if (config_.Headless)
+	{
+		return VkExtent2D{ config_.Width, config_.Height };
+	}
+
 	int width, height;
 	glfwGetWindowSize(window_, &width, &height);
 	return VkExtent2D{ static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
@@ -134,11 +161,17 @@ VkExtent2D Window::WindowSize() const
 
 const char* Window::GetKeyName(const int key, const int scancode) const
 {
-	return glfwGetKeyName(key, scancode);
+	return config_.Headless ? nullptr : glfwGetKeyName(key, scancode);
 }
 
 std::vector<const char*> Window::GetRequiredInstanceExtensions() const
 {
+	// No surface is ever created, but VK_KHR_swapchain (and with it the present image layout) depends on it.
+	if (config_.Headless)
+	{
+		return { VK_KHR_SURFACE_EXTENSION_NAME };
+	}
+
 	uint32_t glfwExtensionCount = 0;
 	const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 	return std::vector<const char*>(glfwExtensions, glfwExtensions + glfwExtensionCount);
@@ -146,11 +179,22 @@ std::vector<const char*> Window::GetRequiredInstanceExtensions() const
 
 double Window::GetTime() const
 {
+	if (config_.Headless)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime_).count();
+	}
+
 	return glfwGetTime();
 }
 
 void Window::Close()
 {
+	if (config_.Headless)
+	{
+		closed_ = true;
+		return;
+	}
+
 	glfwSetWindowShouldClose(window_, 1);
 }
 
@@ -162,6 +206,21 @@ bool Window::IsMinimized() const
 
 void Window::Run()
 {
+	if (config_.Headless)
+	{
+		startTime_ = std::chrono::steady_clock::now();
+
+		while (!closed_)
+		{
+			if (DrawFrame)
+			{
+				DrawFrame();
+			}
+		}
+
+		return;
+	}
+
 	glfwSetTime(0.0);
 
 	while (!glfwWindowShouldClose(window_))
@@ -177,7 +236,22 @@ void Window::Run()
 
 void Window::WaitForEvents() const
 {
+	if (config_.Headless)
+	{
+		return;
+	}
+
 	glfwWaitEvents();
 }
 
+void Window::WaitForEvents(const double timeout) const
+{
+	if (config_.Headless)
+	{
+		return;
+	}
+
+	glfwWaitEventsTimeout(timeout);
+}
+
 }
@@ -2,6 +2,7 @@
 
 #include "WindowConfig.hpp"
 #include "Vulkan.hpp"
+#include <chrono>
 #include <functional>
 #include <vector>
 
@@ -41,11 +42,16 @@ namespace Vulkan
 		bool IsMinimized() const;
 		void Run();
 		void WaitForEvents() const;
+		void WaitForEvents(double timeout) const;
 
 	private:
 
 		const WindowConfig config_;
 		GLFWwindow* window_{};
+
+		// Headless only, stands in for the GLFW clock and close flag.
+		std::chrono::steady_clock::time_point startTime_{};
+		bool closed_{};
 	};
 
 }
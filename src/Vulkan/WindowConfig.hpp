@@ -14,5 +14,7 @@ namespace Vulkan
 		bool Fullscreen;
 		bool Resizable;
 		bool NeedScreenShot;
+		// No GLFW window, surface or present, the frames only go to an offscreen swap chain.
+		bool Headless;
 	};
 }
@@ -4,6 +4,8 @@
 #include "Vulkan/Version.hpp"
 #include "Utilities/Console.hpp"
 #include "Utilities/Exception.hpp"
+#include "Utilities/Tracer.hpp"
+#include "Assets/WeldBenchmark.hpp"
 #include "Options.hpp"
 #include "Application.hpp"
 
@@ -28,6 +30,14 @@ int main(int argc, const char* argv[]) noexcept
     {
         const Options options(argc, argv);
         GOption = &options;
+
+        if (options.BenchWeld)
+        {
+            Assets::WeldBenchmark::Run("../assets/models", 5);
+            return EXIT_SUCCESS;
+        }
+
+        Utilities::Tracer::SetEnabled(!options.TraceFile.empty());
         const UserSettings userSettings = CreateUserSettings(options);
         const Vulkan::WindowConfig windowConfig
         {
@@ -37,7 +47,8 @@ int main(int argc, const char* argv[]) noexcept
             options.Benchmark && options.Fullscreen,
             options.Fullscreen,
             !options.Fullscreen,
-            options.SaveFile
+            options.SaveFile || options.Headless,
+            options.Headless
         };
         
         Vulkan::VulkanBaseRenderer* applicationPtr = nullptr;
@@ -77,6 +88,11 @@ int main(int argc, const char* argv[]) noexcept
 
         delete applicationPtr;
 
+        if (Utilities::Tracer::IsEnabled())
+        {
+            Utilities::Tracer::Dump(options.TraceFile);
+        }
+
         return EXIT_SUCCESS;
     }
 
@@ -128,11 +144,13 @@ namespace
         userSettings.NumberOfSamples = options.Benchmark ? 1 : options.Samples;
         userSettings.NumberOfBounces = options.Benchmark ? 4 : options.Bounces;
         userSettings.MaxNumberOfSamples = options.MaxSamples;
+        userSettings.SampleSky = !options.NoSkySampling;
 
         userSettings.ShowSettings = !options.Benchmark;
         userSettings.ShowOverlay = true;
 
         userSettings.ShowHeatmap = false;
+        userSettings.HeatmapRays = false;
         userSettings.HeatmapScale = 1.5f;
 
         userSettings.UseCheckerBoardRendering = false;